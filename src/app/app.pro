@@ -0,0 +1,44 @@
+QT += core gui widgets sql network mqtt
+DEFINES += QT_SSL_USE_OPENSSL
+TARGET = MQTT_assistant
+TEMPLATE = app
+CONFIG += c++17
+
+include(../core/core.pri)
+
+SOURCES += \
+    main.cpp \
+    ../ui/mainwindow.cpp \
+    ../ui/dialogs/connectiondialog.cpp \
+    ../ui/dialogs/commanddialog.cpp \
+    ../ui/dialogs/scriptdialog.cpp \
+    ../ui/dialogs/loadtestdialog.cpp \
+    ../ui/dialogs/searchdialog.cpp \
+    ../ui/widgets/chatwidget.cpp \
+    ../ui/widgets/collapsiblesection.cpp \
+    ../ui/widgets/messagebubbledelegate.cpp \
+    ../ui/models/messagelistmodel.cpp \
+    ../ui/models/monitortablemodel.cpp \
+    ../ui/widgets/connectionpanel.cpp \
+    ../ui/widgets/commandpanel.cpp \
+    ../ui/widgets/subscriptionpanel.cpp
+
+HEADERS += \
+    ../ui/mainwindow.h \
+    ../ui/dialogs/connectiondialog.h \
+    ../ui/dialogs/commanddialog.h \
+    ../ui/dialogs/scriptdialog.h \
+    ../ui/dialogs/loadtestdialog.h \
+    ../ui/dialogs/searchdialog.h \
+    ../ui/widgets/chatwidget.h \
+    ../ui/widgets/collapsiblesection.h \
+    ../ui/widgets/messagebubbledelegate.h \
+    ../ui/models/messagelistmodel.h \
+    ../ui/models/monitortablemodel.h \
+    ../ui/widgets/connectionpanel.h \
+    ../ui/widgets/commandpanel.h \
+    ../ui/widgets/subscriptionpanel.h
+
+RESOURCES += ../../resources/resources.qrc
+
+RC_ICONS = ../../MQTT.ico
@@ -1,9 +1,11 @@
-#include "src/ui/mainwindow.h"
+#include "ui/mainwindow.h"
+#include "core/logger.h"
 #include <QApplication>
 #include <QFile>
 #include <QDir>
 #include <QStandardPaths>
 #include <QSslSocket>
+#include <QSettings>
 
 int main(int argc, char *argv[])
 {
@@ -16,6 +18,14 @@ int main(int argc, char *argv[])
     QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
     QDir().mkpath(dataDir);
 
+    // Debug log: written asynchronously, rotated at 4 MB
+    Logger::instance().setLevel(Logger::levelFromString(
+        QSettings("MQTTAssistant", "MQTT_assistant").value("debug/logLevel", "info").toString()));
+    Logger::instance().start(dataDir + "/mqtt_debug.log");
+    LOG_INFO("app", QString("Started, SSL support: %1 (%2)")
+                        .arg(QSslSocket::supportsSsl() ? "yes" : "no")
+                        .arg(QSslSocket::sslLibraryVersionString()));
+
     // Load stylesheet
     QFile styleFile(":/styles/main.qss");
     if (styleFile.open(QFile::ReadOnly | QFile::Text)) {
@@ -25,5 +35,7 @@ int main(int argc, char *argv[])
 
     MainWindow w;
     w.show();
-    return app.exec();
+    const int rc = app.exec();
+    Logger::instance().stop();
+    return rc;
 }
@@ -0,0 +1,115 @@
+#ifndef CIRCULARBUFFER_H
+#define CIRCULARBUFFER_H
+
+#include <QtGlobal>
+#include <utility>
+#include <vector>
+
+/**
+ * Bounded ring buffer with stable logical indices 0..size()-1 (0 = oldest).
+ * Appending to a full buffer evicts the oldest element. Storage grows
+ * geometrically up to the capacity as elements arrive, so a large cap costs
+ * nothing until it is used. Not thread-safe; intended as backing store for
+ * item models.
+ */
+template <typename T>
+class CircularBuffer
+{
+public:
+    explicit CircularBuffer(int capacity = 1)
+        : m_capacity(qMax(1, capacity))
+    {
+    }
+
+    int capacity() const { return m_capacity; }
+    int size() const { return m_size; }
+    bool isEmpty() const { return m_size == 0; }
+    bool isFull() const { return m_size == capacity(); }
+
+    T &operator[](int i) { return m_data[physical(i)]; }
+    const T &operator[](int i) const { return m_data[physical(i)]; }
+    const T &at(int i) const { return m_data[physical(i)]; }
+
+    // Returns true if the oldest element was evicted to make room
+    bool append(T value)
+    {
+        const bool evicted = isFull();
+        if (evicted)
+            removeFirst(1);
+        else
+            reserveOneMore();
+        m_data[physical(m_size)] = std::move(value);
+        ++m_size;
+        return evicted;
+    }
+
+    // Returns false (and drops the value) if the buffer is full
+    bool prepend(T value)
+    {
+        if (isFull())
+            return false;
+        reserveOneMore();
+        const int slots = allocated();
+        m_head = (m_head + slots - 1) % slots;
+        m_data[m_head] = std::move(value);
+        ++m_size;
+        return true;
+    }
+
+    void removeFirst(int n)
+    {
+        n = qMin(n, m_size);
+        if (n <= 0)
+            return;
+        for (int i = 0; i < n; ++i)
+            m_data[physical(i)] = T();
+        m_head = (m_head + n) % allocated();
+        m_size -= n;
+    }
+
+    void clear()
+    {
+        removeFirst(m_size);
+        m_head = 0;
+    }
+
+    // Drops everything and releases the storage; existing contents are discarded
+    void setCapacity(int capacity)
+    {
+        std::vector<T>().swap(m_data);
+        m_capacity = qMax(1, capacity);
+        m_head = 0;
+        m_size = 0;
+    }
+
+private:
+    static constexpr int kMinAllocation = 64;
+
+    int allocated() const { return static_cast<int>(m_data.size()); }
+
+    std::size_t physical(int i) const
+    {
+        return static_cast<std::size_t>((m_head + i) % allocated());
+    }
+
+    // Makes room for one more element below the capacity, unrolling the
+    // ring into a larger block when the current one is full
+    void reserveOneMore()
+    {
+        if (m_size < allocated())
+            return;
+        const int slots = qMin(m_capacity, qMax(kMinAllocation, allocated() * 2));
+        std::vector<T> grown(static_cast<std::size_t>(slots));
+        for (int i = 0; i < m_size; ++i)
+            grown[static_cast<std::size_t>(i)] = std::move(m_data[physical(i)]);
+        m_data.swap(grown);
+        m_head = 0;
+    }
+
+    std::vector<T> m_data;  // allocated slots, <= m_capacity
+    int m_capacity;
+    int m_head = 0;
+    int m_size = 0;
+};
+
+#endif // CIRCULARBUFFER_H
@@ -0,0 +1,138 @@
+#include "connectionmanager.h"
+#include "mqttclient.h"
+#include "scriptengine.h"
+#include "logger.h"
+#include <QThread>
+#include <QTimer>
+
+ConnectionManager::ConnectionManager(int threadCount, QObject *parent)
+    : QObject(parent)
+    , m_sampleTimer(new QTimer(this))
+{
+    if (threadCount <= 0)
+        threadCount = qMax(1, QThread::idealThreadCount());
+
+    m_threads.reserve(threadCount);
+    for (int i = 0; i < threadCount; ++i) {
+        QThread *thread = new QThread(this);
+        thread->setObjectName(QString("MQTT I/O %1").arg(i));
+        thread->start();
+        m_threads.append(thread);
+    }
+
+    m_sampleTimer->setInterval(kSampleIntervalMs);
+    connect(m_sampleTimer, &QTimer::timeout, this, &ConnectionManager::sample);
+    m_sampleTimer->start();
+    m_sampleClock.start();
+}
+
+ConnectionManager::~ConnectionManager()
+{
+    for (int id : m_connections.keys())
+        remove(id);
+    // Pending deleteLater() calls run as each thread finishes
+    for (QThread *thread : m_threads) {
+        thread->quit();
+        thread->wait();
+    }
+}
+
+MqttClient *ConnectionManager::create(int connectionId)
+{
+    auto it = m_connections.find(connectionId);
+    if (it != m_connections.end())
+        return it->client;
+
+    const int index = leastLoadedThread();
+    QThread *thread = m_threads.at(index);
+
+    // Created here without a parent, then handed to the I/O thread
+    Entry entry;
+    entry.client = new MqttClient();
+    entry.client->moveToThread(thread);
+
+    // Scripts run next to their client, off the GUI thread
+    entry.engine = new ScriptEngine();
+    entry.engine->moveToThread(thread);
+    entry.engine->setClient(entry.client);
+
+    entry.load.connectionId = connectionId;
+    entry.load.threadIndex  = index;
+    m_connections.insert(connectionId, entry);
+
+    LOG_INFO("connections", QString("Connection %1 assigned to I/O thread %2 (%3 connections)")
+                                .arg(connectionId).arg(index).arg(m_connections.size()));
+    return entry.client;
+}
+
+void ConnectionManager::remove(int connectionId)
+{
+    auto it = m_connections.find(connectionId);
+    if (it == m_connections.end())
+        return;
+    const Entry entry = it.value();
+    m_connections.erase(it);
+
+    // Events for one object run in posting order: the disconnect happens
+    // before the deferred delete. The engine goes first so it never sees a
+    // dangling client.
+    entry.engine->deleteLater();
+    QMetaObject::invokeMethod(entry.client, "disconnectFromHost", Qt::QueuedConnection);
+    entry.client->deleteLater();
+}
+
+MqttClient *ConnectionManager::client(int connectionId) const
+{
+    auto it = m_connections.constFind(connectionId);
+    return it != m_connections.constEnd() ? it->client : nullptr;
+}
+
+ScriptEngine *ConnectionManager::scriptEngine(int connectionId) const
+{
+    auto it = m_connections.constFind(connectionId);
+    return it != m_connections.constEnd() ? it->engine : nullptr;
+}
+
+ConnectionLoad ConnectionManager::load(int connectionId) const
+{
+    return m_connections.value(connectionId).load;
+}
+
+QList<ConnectionLoad> ConnectionManager::loads() const
+{
+    QList<ConnectionLoad> list;
+    list.reserve(m_connections.size());
+    for (const Entry &entry : m_connections)
+        list.append(entry.load);
+    return list;
+}
+
+int ConnectionManager::leastLoadedThread() const
+{
+    QVector<double> score(m_threads.size(), 0.0);
+    for (const Entry &entry : m_connections)
+        score[entry.load.threadIndex] += kConnectionWeight
+                                       + entry.load.receiveRate + entry.load.publishRate;
+
+    int best = 0;
+    for (int i = 1; i < score.size(); ++i) {
+        if (score[i] < score[best])
+            best = i;
+    }
+    return best;
+}
+
+void ConnectionManager::sample()
+{
+    const double seconds = qMax<qint64>(1, m_sampleClock.restart()) / 1000.0;
+    for (Entry &entry : m_connections) {
+        // Counters are atomics written on the I/O thread
+        const quint64 received  = entry.client->receivedCount();
+        const quint64 published = entry.client->publishedCount();
+        entry.load.receiveRate = (received - entry.load.received) / seconds;
+        entry.load.publishRate = (published - entry.load.published) / seconds;
+        entry.load.received    = received;
+        entry.load.published   = published;
+    }
+    emit loadsSampled();
+}
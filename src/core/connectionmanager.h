@@ -0,0 +1,83 @@
+#ifndef CONNECTIONMANAGER_H
+#define CONNECTIONMANAGER_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QVector>
+#include <QElapsedTimer>
+
+class QThread;
+class QTimer;
+class MqttClient;
+class ScriptEngine;
+
+// Per-connection traffic, sampled every ConnectionManager::kSampleIntervalMs
+struct ConnectionLoad {
+    int     connectionId = -1;
+    int     threadIndex  = -1;
+    quint64 received     = 0;   // totals since the client was created
+    quint64 published    = 0;
+    double  receiveRate  = 0.0; // messages/s over the last sample
+    double  publishRate  = 0.0;
+};
+
+/**
+ * Owns every MqttClient and its ScriptEngine. Instead of one thread per
+ * connection, clients are multiplexed over a fixed pool of I/O threads
+ * sized to the core count; each new connection goes to the thread with the
+ * lowest load score (connection count plus recent message rate), so a busy
+ * broker does not share a thread with many others. A client stays on its
+ * thread for its lifetime.
+ *
+ * GUI thread only. Clients and engines live on the pool threads and are
+ * deleted there.
+ */
+class ConnectionManager : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ConnectionManager(int threadCount = 0, QObject *parent = nullptr);
+    ~ConnectionManager();
+
+    // Creates the client and its script engine on the least-loaded thread;
+    // returns the existing client if the connection already has one
+    MqttClient *create(int connectionId);
+    void remove(int connectionId); // disconnects and deletes asynchronously
+
+    bool contains(int connectionId) const { return m_connections.contains(connectionId); }
+    MqttClient *client(int connectionId) const;
+    ScriptEngine *scriptEngine(int connectionId) const;
+    QList<int> connectionIds() const { return m_connections.keys(); }
+    int count() const { return m_connections.size(); }
+    int threadCount() const { return m_threads.size(); }
+
+    ConnectionLoad load(int connectionId) const;
+    QList<ConnectionLoad> loads() const;
+
+    static const int kSampleIntervalMs = 1000;
+    // One connection weighs as much as this many messages per second
+    static const int kConnectionWeight = 100;
+
+signals:
+    void loadsSampled();
+
+private slots:
+    void sample();
+
+private:
+    struct Entry {
+        MqttClient    *client = nullptr;
+        ScriptEngine  *engine = nullptr;
+        ConnectionLoad load;
+    };
+
+    int leastLoadedThread() const;
+
+    QVector<QThread *>     m_threads;
+    QHash<int, Entry>      m_connections; // connectionId -> client, engine, load
+    QTimer                *m_sampleTimer;
+    QElapsedTimer          m_sampleClock;
+};
+
+#endif // CONNECTIONMANAGER_H
@@ -0,0 +1,14 @@
+# Link against the core static library (src/core/core.pro).
+# Include from a project one level below src/.
+INCLUDEPATH += $$PWD/..
+DEPENDPATH  += $$PWD
+
+CORE_LIB_DIR = $$OUT_PWD/../core
+win32 {
+    CONFIG(debug, debug|release): CORE_LIB_DIR = $$CORE_LIB_DIR/debug
+    else: CORE_LIB_DIR = $$CORE_LIB_DIR/release
+}
+
+LIBS += -L$$CORE_LIB_DIR -lmqttcore
+win32-msvc*: PRE_TARGETDEPS += $$CORE_LIB_DIR/mqttcore.lib
+else: PRE_TARGETDEPS += $$CORE_LIB_DIR/libmqttcore.a
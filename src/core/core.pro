@@ -0,0 +1,52 @@
+# Core library: MQTT clients, scripting and storage. QtCore-only so it can
+# be linked into both the GUI and the headless runner.
+QT = core sql network mqtt
+DEFINES += QT_SSL_USE_OPENSSL
+TEMPLATE = lib
+CONFIG += staticlib c++17
+TARGET = mqttcore
+
+INCLUDEPATH += $$PWD/..
+
+SOURCES += \
+    mqttclient.cpp \
+    databasemanager.cpp \
+    persistenceworker.cpp \
+    messageingestor.cpp \
+    inboundmessage.cpp \
+    topicregistry.cpp \
+    payloadformat.cpp \
+    scriptengine.cpp \
+    topicfiltertrie.cpp \
+    triggercondition.cpp \
+    messagetemplate.cpp \
+    loadgenerator.cpp \
+    logger.cpp \
+    tlsconfigcache.cpp \
+    connectionmanager.cpp \
+    metatypes.cpp \
+    headlessrunner.cpp
+
+HEADERS += \
+    models.h \
+    mqttclient.h \
+    databasemanager.h \
+    persistenceworker.h \
+    messageingestor.h \
+    inboundmessage.h \
+    topicregistry.h \
+    payloadformat.h \
+    spscqueue.h \
+    mpscqueue.h \
+    logger.h \
+    tlsconfigcache.h \
+    connectionmanager.h \
+    timingwheel.h \
+    circularbuffer.h \
+    scriptengine.h \
+    topicfiltertrie.h \
+    triggercondition.h \
+    messagetemplate.h \
+    loadgenerator.h \
+    metatypes.h \
+    headlessrunner.h
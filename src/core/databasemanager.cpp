@@ -6,9 +6,36 @@
 #include <QFileInfo>
 #include <QDebug>
 #include <QVariant>
+#include <QStringList>
+#include <QDateTime>
+#include <QRegularExpression>
+#include "topicregistry.h"
+#include "topicfiltertrie.h"
+#include <limits>
+
+DatabaseTuning DatabaseTuning::forProfile(const QString &profile)
+{
+    DatabaseTuning t;
+    if (profile == "safe") {
+        t.journalMode  = "DELETE";
+        t.synchronous  = "FULL";
+        t.mmapSize     = 0;
+        t.cacheSizeKiB = 2000;
+        t.tempStore    = "DEFAULT";
+    } else {
+        // "balanced" and "fast"
+        t.journalMode  = "WAL";
+        t.synchronous  = (profile == "fast") ? "OFF" : "NORMAL";
+        t.mmapSize     = 256LL * 1024 * 1024;
+        t.cacheSizeKiB = 64 * 1024;
+        t.tempStore    = "MEMORY";
+    }
+    return t;
+}
 
 DatabaseManager::DatabaseManager(QObject *parent)
     : QObject(parent)
+    , m_tuning(DatabaseTuning::forProfile("balanced"))
 {
 }
 
@@ -17,7 +44,7 @@ DatabaseManager::~DatabaseManager()
     close();
 }
 
-bool DatabaseManager::open(const QString &dbPath)
+bool DatabaseManager::open(const QString &dbPath, const QString &connectionName)
 {
     QString path = dbPath;
     if (path.isEmpty()) {
@@ -28,25 +55,119 @@ bool DatabaseManager::open(const QString &dbPath)
         QDir().mkpath(QFileInfo(path).absolutePath());
     }
 
-    m_db = QSqlDatabase::addDatabase("QSQLITE", "mqtt_assistant_db");
+    m_db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
     m_db.setDatabaseName(path);
+    // The GUI and the persistence worker hold separate connections; wait for
+    // the other side's write lock instead of failing with SQLITE_BUSY
+    m_db.setConnectOptions("QSQLITE_BUSY_TIMEOUT=5000");
 
     if (!m_db.open()) {
         qWarning() << "Failed to open database:" << m_db.lastError().text();
         return false;
     }
-    return createTables();
+    applyTuning(true);
+    if (!migrate())
+        return false;
+
+    refreshFullTextState();
+    // Migration 6 leaves the index out when SQLite lacks FTS5 / trigram;
+    // try again in case this build has it
+    if (!m_hasFullTextIndex)
+        ensureFullTextIndex();
+    return true;
+}
+
+bool DatabaseManager::openReadOnly(const QString &dbPath, const QString &connectionName)
+{
+    m_db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+    m_db.setDatabaseName(dbPath);
+    m_db.setConnectOptions("QSQLITE_OPEN_READONLY;QSQLITE_BUSY_TIMEOUT=5000");
+
+    if (!m_db.open()) {
+        qWarning() << "Failed to open database read-only:" << m_db.lastError().text();
+        return false;
+    }
+    // Journal mode belongs to the file and was set by the writer; only read it
+    QSqlQuery q(m_db);
+    if (q.exec("PRAGMA journal_mode") && q.next())
+        m_journalMode = q.value(0).toString().toLower();
+    q.finish();
+    applyTuning(false);
+
+    refreshFullTextState();
+    return true;
 }
 
 void DatabaseManager::close()
 {
+    // Prepared statements must be released before the connection closes
+    m_statements.clear();
+    m_topicRowIds.clear();
+    m_hasFullTextIndex = false;
+    m_fullTextPending  = false;
+    m_journalMode.clear();
     if (m_db.isOpen())
         m_db.close();
 }
 
-bool DatabaseManager::createTables()
+void DatabaseManager::setDurabilityProfile(const QString &profile)
+{
+    m_tuning = DatabaseTuning::forProfile(profile);
+    if (m_db.isOpen())
+        applyTuning(false);
+}
+
+void DatabaseManager::applyTuning(bool includeJournalMode)
 {
     QSqlQuery q(m_db);
+    if (includeJournalMode) {
+        // The PRAGMA answers with the mode actually in effect, which stays
+        // unchanged (without an error) if SQLite cannot switch
+        const QString pragma = "PRAGMA journal_mode=" + m_tuning.journalMode;
+        if (q.exec(pragma) && q.next())
+            m_journalMode = q.value(0).toString().toLower();
+        else
+            qWarning() << pragma << q.lastError().text();
+        if (m_journalMode.compare(m_tuning.journalMode, Qt::CaseInsensitive) != 0)
+            qWarning() << pragma << "left the database in journal mode" << m_journalMode;
+        q.finish();
+    }
+
+    const QStringList pragmas = {
+        "PRAGMA synchronous="  + m_tuning.synchronous,
+        "PRAGMA mmap_size="    + QString::number(m_tuning.mmapSize),
+        // Negative cache_size is interpreted by SQLite as KiB rather than pages
+        "PRAGMA cache_size=-"  + QString::number(m_tuning.cacheSizeKiB),
+        "PRAGMA temp_store="   + m_tuning.tempStore,
+    };
+    for (const QString &pragma : pragmas) {
+        if (!q.exec(pragma))
+            qWarning() << pragma << q.lastError().text();
+    }
+}
+
+QSqlQuery &DatabaseManager::cachedQuery(const QString &sql)
+{
+    auto it = m_statements.find(sql);
+    if (it == m_statements.end()) {
+        QSqlQuery q(m_db);
+        q.setForwardOnly(true);
+        if (!q.prepare(sql))
+            qWarning() << "Failed to prepare:" << sql << q.lastError().text();
+        it = m_statements.emplace(sql, std::move(q)).first;
+    }
+    return it->second;
+}
+
+// ---- Schema migrations ----
+
+namespace {
+
+// v1: the original schema. CREATE ... IF NOT EXISTS so databases created
+// before schema_version existed adopt it without changes.
+bool migrateBaseSchema(QSqlDatabase &db)
+{
+    QSqlQuery q(db);
 
     bool ok = q.exec(
         "CREATE TABLE IF NOT EXISTS connections ("
@@ -125,15 +246,315 @@ bool DatabaseManager::createTables()
     return true;
 }
 
+// v2: the messages table is always read per connection, newest first
+bool migrateMessageIndexes(QSqlDatabase &db)
+{
+    QSqlQuery q(db);
+    const QStringList statements = {
+        "ALTER TABLE messages ADD COLUMN retained INTEGER NOT NULL DEFAULT 0",
+        "CREATE INDEX IF NOT EXISTS idx_messages_conn_id ON messages(connection_id, id)",
+        "CREATE INDEX IF NOT EXISTS idx_messages_conn_topic_id ON messages(connection_id, topic, id)",
+        "CREATE INDEX IF NOT EXISTS idx_subscriptions_conn ON subscriptions(connection_id, id)",
+    };
+    for (const QString &sql : statements) {
+        if (!q.exec(sql)) { qWarning() << q.lastError().text(); return false; }
+    }
+    return true;
+}
+
+// v3: timestamps become INTEGER epoch milliseconds. SQLite cannot change a
+// column type in place, so the table is rebuilt. The old ISO strings were
+// written in local time without an offset, hence the 'utc' modifier.
+bool migrateIntegerTimestamps(QSqlDatabase &db)
+{
+    QSqlQuery q(db);
+    const QStringList statements = {
+        "CREATE TABLE messages_v3 ("
+        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "connection_id INTEGER NOT NULL,"
+        "topic TEXT NOT NULL,"
+        "payload TEXT,"
+        "outgoing INTEGER NOT NULL DEFAULT 0,"
+        "retained INTEGER NOT NULL DEFAULT 0,"
+        "timestamp INTEGER NOT NULL"
+        ")",
+        "INSERT INTO messages_v3 (id,connection_id,topic,payload,outgoing,retained,timestamp) "
+        "SELECT id,connection_id,topic,payload,outgoing,retained,"
+        "COALESCE(CAST(strftime('%s', timestamp, 'utc') AS INTEGER) * 1000, 0) FROM messages",
+        "DROP TABLE messages",
+        "ALTER TABLE messages_v3 RENAME TO messages",
+        "CREATE INDEX idx_messages_conn_id ON messages(connection_id, id)",
+        "CREATE INDEX idx_messages_conn_topic_id ON messages(connection_id, topic, id)",
+        "CREATE INDEX idx_messages_conn_ts ON messages(connection_id, timestamp)",
+    };
+    for (const QString &sql : statements) {
+        if (!q.exec(sql)) { qWarning() << q.lastError().text(); return false; }
+    }
+    return true;
+}
+
+// v4: payloads are stored as raw bytes (BLOB values; SQLite leaves them
+// untouched despite the TEXT column affinity). Rows written by older builds
+// as "HEX: 0A 1B ..." strings are decoded back to the original bytes.
+bool migrateHexPayloadsToBytes(QSqlDatabase &db)
+{
+    static const QRegularExpression hexRx("^HEX: [0-9A-F]{2}( [0-9A-F]{2})*$");
+
+    QList<QPair<qint64, QByteArray>> rows;
+    QSqlQuery q(db);
+    q.setForwardOnly(true);
+    if (!q.exec("SELECT id,payload FROM messages WHERE payload LIKE 'HEX: %'")) {
+        qWarning() << q.lastError().text();
+        return false;
+    }
+    while (q.next()) {
+        const QString text = q.value(1).toString();
+        if (hexRx.match(text).hasMatch())
+            rows.append({ q.value(0).toLongLong(), QByteArray::fromHex(text.mid(5).toLatin1()) });
+    }
+    q.finish();
+
+    q.prepare("UPDATE messages SET payload=:payload WHERE id=:id");
+    for (const auto &row : rows) {
+        q.bindValue(":payload", row.second);
+        q.bindValue(":id",      row.first);
+        if (!q.exec()) { qWarning() << q.lastError().text(); return false; }
+    }
+    return true;
+}
+
+// v5: topics are interned in their own table and messages reference them by
+// id, so a topic repeated across millions of rows is stored once
+bool migrateTopicTable(QSqlDatabase &db)
+{
+    QSqlQuery q(db);
+    const QStringList statements = {
+        "CREATE TABLE topics ("
+        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "name TEXT NOT NULL UNIQUE"
+        ")",
+        "INSERT INTO topics (name) SELECT DISTINCT topic FROM messages",
+        "CREATE TABLE messages_v5 ("
+        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "connection_id INTEGER NOT NULL,"
+        "topic_id INTEGER NOT NULL REFERENCES topics(id),"
+        "payload TEXT,"
+        "outgoing INTEGER NOT NULL DEFAULT 0,"
+        "retained INTEGER NOT NULL DEFAULT 0,"
+        "timestamp INTEGER NOT NULL"
+        ")",
+        "INSERT INTO messages_v5 (id,connection_id,topic_id,payload,outgoing,retained,timestamp) "
+        "SELECT m.id,m.connection_id,t.id,m.payload,m.outgoing,m.retained,m.timestamp "
+        "FROM messages m JOIN topics t ON t.name = m.topic",
+        "DROP TABLE messages",
+        "ALTER TABLE messages_v5 RENAME TO messages",
+        "CREATE INDEX idx_messages_conn_id ON messages(connection_id, id)",
+        "CREATE INDEX idx_messages_conn_topic_id ON messages(connection_id, topic_id, id)",
+        "CREATE INDEX idx_messages_conn_ts ON messages(connection_id, timestamp)",
+    };
+    for (const QString &sql : statements) {
+        if (!q.exec(sql)) { qWarning() << q.lastError().text(); return false; }
+    }
+    return true;
+}
+
+// Payload full-text index. External-content FTS5 table with the trigram
+// tokenizer (substring matches, works for CJK text too), kept in sync by
+// triggers. Rows that predate the index are listed in fts_backfill and
+// indexed later by DatabaseManager::backfillFullTextIndex(); until then the
+// delete/update triggers must leave them alone, since removing a row the
+// index never saw corrupts an external-content table. Sets *created to
+// false (and succeeds) when SQLite lacks FTS5 / trigram.
+bool createFullTextIndex(QSqlDatabase &db, bool *created)
+{
+    *created = false;
+    QSqlQuery q(db);
+    if (!q.exec("CREATE VIRTUAL TABLE messages_fts USING fts5("
+                "payload, content='messages', content_rowid='id', tokenize='trigram')")) {
+        qWarning() << "Full-text index unavailable, search will use LIKE:" << q.lastError().text();
+        return true;
+    }
+    const QString notPending =
+        "NOT EXISTS (SELECT 1 FROM fts_backfill WHERE old.id > done AND old.id <= upto)";
+    const QStringList statements = {
+        "CREATE TABLE IF NOT EXISTS fts_backfill ("
+        "id INTEGER PRIMARY KEY CHECK (id = 1),"
+        "done INTEGER NOT NULL,"
+        "upto INTEGER NOT NULL"
+        ")",
+        // Everything up to the current newest row; later rows go through the trigger
+        "INSERT INTO fts_backfill (id, done, upto) "
+        "SELECT 1, 0, newest FROM (SELECT MAX(id) AS newest FROM messages) WHERE newest IS NOT NULL",
+        "CREATE TRIGGER messages_fts_ai AFTER INSERT ON messages BEGIN "
+        "INSERT INTO messages_fts(rowid, payload) VALUES (new.id, new.payload); END",
+        "CREATE TRIGGER messages_fts_ad AFTER DELETE ON messages WHEN " + notPending + " BEGIN "
+        "INSERT INTO messages_fts(messages_fts, rowid, payload) VALUES ('delete', old.id, old.payload); END",
+        "CREATE TRIGGER messages_fts_au AFTER UPDATE OF payload ON messages WHEN " + notPending + " BEGIN "
+        "INSERT INTO messages_fts(messages_fts, rowid, payload) VALUES ('delete', old.id, old.payload); "
+        "INSERT INTO messages_fts(rowid, payload) VALUES (new.id, new.payload); END",
+    };
+    for (const QString &sql : statements) {
+        if (!q.exec(sql)) { qWarning() << q.lastError().text(); return false; }
+    }
+    *created = true;
+    return true;
+}
+
+// v6: payload full-text index, without indexing the existing history (that
+// runs on the persistence thread). Without FTS5 the step still counts as
+// applied; open() keeps retrying the index on every start.
+bool migrateFullTextIndex(QSqlDatabase &db)
+{
+    bool created = false;
+    return createFullTextIndex(db, &created);
+}
+
+struct Migration {
+    int version;
+    const char *description;
+    bool (*apply)(QSqlDatabase &db);
+};
+
+// Append new steps at the end; never edit or reorder a released step
+const Migration kMigrations[] = {
+    { 1, "base schema",                         &migrateBaseSchema },
+    { 2, "message indexes and retained flag",   &migrateMessageIndexes },
+    { 3, "integer epoch-ms message timestamps", &migrateIntegerTimestamps },
+    { 4, "raw byte payloads",                   &migrateHexPayloadsToBytes },
+    { 5, "interned topics table",               &migrateTopicTable },
+    { 6, "payload full-text index",             &migrateFullTextIndex },
+};
+
+} // namespace
+
+void DatabaseManager::refreshFullTextState()
+{
+    QSqlQuery q(m_db);
+    m_hasFullTextIndex = q.exec("SELECT 1 FROM sqlite_master WHERE name='messages_fts'") && q.next();
+    q.finish();
+    // Databases indexed before the backfill was split out have no fts_backfill
+    m_fullTextPending = m_hasFullTextIndex && q.exec("SELECT 1 FROM fts_backfill") && q.next();
+}
+
+void DatabaseManager::ensureFullTextIndex()
+{
+    QSqlQuery q(m_db);
+    if (!q.exec("BEGIN IMMEDIATE")) { qWarning() << q.lastError().text(); return; }
+    // Another connection may have created it since refreshFullTextState()
+    bool created = false;
+    const bool exists = q.exec("SELECT 1 FROM sqlite_master WHERE name='messages_fts'") && q.next();
+    q.finish();
+    if (!exists && !createFullTextIndex(m_db, &created)) {
+        q.exec("ROLLBACK");
+        return;
+    }
+    if (!q.exec("COMMIT")) { qWarning() << q.lastError().text(); return; }
+    if (created)
+        qInfo() << "Full-text index created; existing messages are indexed in the background";
+    refreshFullTextState();
+}
+
+int DatabaseManager::backfillFullTextIndex(int chunkRows)
+{
+    QSqlQuery q(m_db);
+    if (!q.exec("SELECT done, upto FROM fts_backfill") || !q.next()) {
+        m_fullTextPending = false;
+        return 100;
+    }
+    const qint64 done = q.value(0).toLongLong();
+    const qint64 upto = q.value(1).toLongLong();
+    q.finish();
+    const qint64 end = qMin(upto, done + qMax(1, chunkRows));
+    const bool last  = end >= upto;
+
+    if (!q.exec("BEGIN IMMEDIATE")) { qWarning() << q.lastError().text(); return -1; }
+    q.prepare("INSERT INTO messages_fts(rowid, payload) "
+              "SELECT id, payload FROM messages WHERE id > :done AND id <= :end");
+    q.bindValue(":done", done);
+    q.bindValue(":end",  end);
+    bool ok = q.exec();
+    if (ok && last) {
+        ok = q.exec("DELETE FROM fts_backfill");
+    } else if (ok) {
+        q.prepare("UPDATE fts_backfill SET done=:end");
+        q.bindValue(":end", end);
+        ok = q.exec();
+    }
+    if (!ok || !q.exec("COMMIT")) {
+        qWarning() << "Full-text backfill failed:" << q.lastError().text();
+        q.exec("ROLLBACK");
+        return -1;
+    }
+
+    if (last) {
+        m_fullTextPending = false;
+        return 100;
+    }
+    return upto > 0 ? static_cast<int>(end * 100 / upto) : 100;
+}
+
+bool DatabaseManager::migrate()
+{
+    QSqlQuery q(m_db);
+    if (!q.exec("CREATE TABLE IF NOT EXISTS schema_version ("
+                "version INTEGER PRIMARY KEY,"
+                "description TEXT,"
+                "applied_at TEXT NOT NULL"
+                ")")) {
+        qWarning() << q.lastError().text();
+        return false;
+    }
+
+    for (const Migration &m : kMigrations) {
+        // BEGIN IMMEDIATE takes the write lock up front, so two connections
+        // opening the same file cannot both apply the same step
+        if (!q.exec("BEGIN IMMEDIATE")) { qWarning() << q.lastError().text(); return false; }
+
+        q.prepare("SELECT 1 FROM schema_version WHERE version=:v");
+        q.bindValue(":v", m.version);
+        const bool applied = q.exec() && q.next();
+        q.finish();
+        if (applied) {
+            q.exec("COMMIT");
+            continue;
+        }
+
+        if (!m.apply(m_db)) {
+            qWarning() << "Schema migration" << m.version << "failed:" << m.description;
+            q.exec("ROLLBACK");
+            return false;
+        }
+        q.prepare("INSERT INTO schema_version (version,description,applied_at) "
+                  "VALUES (:v,:d,:at)");
+        q.bindValue(":v",  m.version);
+        q.bindValue(":d",  QString::fromLatin1(m.description));
+        q.bindValue(":at", QDateTime::currentDateTime().toString(Qt::ISODate));
+        if (!q.exec() || !q.exec("COMMIT")) {
+            qWarning() << q.lastError().text();
+            q.exec("ROLLBACK");
+            return false;
+        }
+    }
+    return true;
+}
+
+int DatabaseManager::schemaVersion()
+{
+    QSqlQuery q(m_db);
+    if (!q.exec("SELECT MAX(version) FROM schema_version") || !q.next())
+        return 0;
+    return q.value(0).toInt();
+}
+
 // ---- Connections ----
 
 QList<MqttConnectionConfig> DatabaseManager::loadConnections()
 {
     QList<MqttConnectionConfig> list;
-    QSqlQuery q(m_db);
-    q.exec("SELECT id,name,host,port,username,password,client_id,"
-           "use_tls,ca_cert_path,client_cert_path,client_key_path,"
-           "clean_session,keep_alive FROM connections ORDER BY id");
+    QSqlQuery &q = cachedQuery("SELECT id,name,host,port,username,password,client_id,"
+                               "use_tls,ca_cert_path,client_cert_path,client_key_path,"
+                               "clean_session,keep_alive FROM connections ORDER BY id");
+    if (!q.exec()) { qWarning() << q.lastError().text(); return list; }
     while (q.next()) {
         MqttConnectionConfig c;
         c.id              = q.value(0).toInt();
@@ -151,15 +572,15 @@ QList<MqttConnectionConfig> DatabaseManager::loadConnections()
         c.keepAlive       = q.value(12).toInt();
         list.append(c);
     }
+    q.finish(); // release the read cursor; the statement stays prepared
     return list;
 }
 
 int DatabaseManager::saveConnection(const MqttConnectionConfig &config)
 {
-    QSqlQuery q(m_db);
-    q.prepare("INSERT INTO connections (name,host,port,username,password,client_id,"
-              "use_tls,ca_cert_path,client_cert_path,client_key_path,clean_session,keep_alive) "
-              "VALUES (:name,:host,:port,:user,:pass,:cid,:tls,:ca,:cc,:ck,:cs,:ka)");
+    QSqlQuery &q = cachedQuery("INSERT INTO connections (name,host,port,username,password,client_id,"
+                               "use_tls,ca_cert_path,client_cert_path,client_key_path,clean_session,keep_alive) "
+                               "VALUES (:name,:host,:port,:user,:pass,:cid,:tls,:ca,:cc,:ck,:cs,:ka)");
     q.bindValue(":name", config.name);
     q.bindValue(":host", config.host);
     q.bindValue(":port", config.port);
@@ -178,11 +599,10 @@ int DatabaseManager::saveConnection(const MqttConnectionConfig &config)
 
 bool DatabaseManager::updateConnection(const MqttConnectionConfig &config)
 {
-    QSqlQuery q(m_db);
-    q.prepare("UPDATE connections SET name=:name,host=:host,port=:port,username=:user,"
-              "password=:pass,client_id=:cid,use_tls=:tls,ca_cert_path=:ca,"
-              "client_cert_path=:cc,client_key_path=:ck,clean_session=:cs,keep_alive=:ka "
-              "WHERE id=:id");
+    QSqlQuery &q = cachedQuery("UPDATE connections SET name=:name,host=:host,port=:port,username=:user,"
+                               "password=:pass,client_id=:cid,use_tls=:tls,ca_cert_path=:ca,"
+                               "client_cert_path=:cc,client_key_path=:ck,clean_session=:cs,keep_alive=:ka "
+                               "WHERE id=:id");
     q.bindValue(":name", config.name);
     q.bindValue(":host", config.host);
     q.bindValue(":port", config.port);
@@ -202,8 +622,7 @@ bool DatabaseManager::updateConnection(const MqttConnectionConfig &config)
 
 bool DatabaseManager::deleteConnection(int id)
 {
-    QSqlQuery q(m_db);
-    q.prepare("DELETE FROM connections WHERE id=:id");
+    QSqlQuery &q = cachedQuery("DELETE FROM connections WHERE id=:id");
     q.bindValue(":id", id);
     return q.exec();
 }
@@ -213,9 +632,9 @@ bool DatabaseManager::deleteConnection(int id)
 QList<CommandConfig> DatabaseManager::loadCommands()
 {
     QList<CommandConfig> list;
-    QSqlQuery q(m_db);
-    q.exec("SELECT id,name,topic,payload,qos,retain,loop_enabled,loop_interval_ms,connection_id "
-           "FROM commands ORDER BY id");
+    QSqlQuery &q = cachedQuery("SELECT id,name,topic,payload,qos,retain,loop_enabled,loop_interval_ms,connection_id "
+                               "FROM commands ORDER BY id");
+    if (!q.exec()) { qWarning() << q.lastError().text(); return list; }
     while (q.next()) {
         CommandConfig c;
         c.id             = q.value(0).toInt();
@@ -229,14 +648,14 @@ QList<CommandConfig> DatabaseManager::loadCommands()
         c.connectionId   = q.value(8).toInt();
         list.append(c);
     }
+    q.finish();
     return list;
 }
 
 int DatabaseManager::saveCommand(const CommandConfig &cmd)
 {
-    QSqlQuery q(m_db);
-    q.prepare("INSERT INTO commands (name,topic,payload,qos,retain,loop_enabled,loop_interval_ms,connection_id) "
-              "VALUES (:name,:topic,:payload,:qos,:retain,:loop,:interval,:connid)");
+    QSqlQuery &q = cachedQuery("INSERT INTO commands (name,topic,payload,qos,retain,loop_enabled,loop_interval_ms,connection_id) "
+                               "VALUES (:name,:topic,:payload,:qos,:retain,:loop,:interval,:connid)");
     q.bindValue(":name",     cmd.name);
     q.bindValue(":topic",    cmd.topic);
     q.bindValue(":payload",  cmd.payload);
@@ -251,10 +670,9 @@ int DatabaseManager::saveCommand(const CommandConfig &cmd)
 
 bool DatabaseManager::updateCommand(const CommandConfig &cmd)
 {
-    QSqlQuery q(m_db);
-    q.prepare("UPDATE commands SET name=:name,topic=:topic,payload=:payload,qos=:qos,"
-              "retain=:retain,loop_enabled=:loop,loop_interval_ms=:interval,connection_id=:connid "
-              "WHERE id=:id");
+    QSqlQuery &q = cachedQuery("UPDATE commands SET name=:name,topic=:topic,payload=:payload,qos=:qos,"
+                               "retain=:retain,loop_enabled=:loop,loop_interval_ms=:interval,connection_id=:connid "
+                               "WHERE id=:id");
     q.bindValue(":name",     cmd.name);
     q.bindValue(":topic",    cmd.topic);
     q.bindValue(":payload",  cmd.payload);
@@ -270,8 +688,7 @@ bool DatabaseManager::updateCommand(const CommandConfig &cmd)
 
 bool DatabaseManager::deleteCommand(int id)
 {
-    QSqlQuery q(m_db);
-    q.prepare("DELETE FROM commands WHERE id=:id");
+    QSqlQuery &q = cachedQuery("DELETE FROM commands WHERE id=:id");
     q.bindValue(":id", id);
     return q.exec();
 }
@@ -281,10 +698,10 @@ bool DatabaseManager::deleteCommand(int id)
 QList<ScriptConfig> DatabaseManager::loadScripts()
 {
     QList<ScriptConfig> list;
-    QSqlQuery q(m_db);
-    q.exec("SELECT id,name,enabled,trigger_topic,trigger_condition,trigger_value,"
-           "response_topic,response_payload,response_qos,response_retain,delay_ms,connection_id "
-           "FROM scripts ORDER BY id");
+    QSqlQuery &q = cachedQuery("SELECT id,name,enabled,trigger_topic,trigger_condition,trigger_value,"
+                               "response_topic,response_payload,response_qos,response_retain,delay_ms,connection_id "
+                               "FROM scripts ORDER BY id");
+    if (!q.exec()) { qWarning() << q.lastError().text(); return list; }
     while (q.next()) {
         ScriptConfig s;
         s.id               = q.value(0).toInt();
@@ -301,15 +718,15 @@ QList<ScriptConfig> DatabaseManager::loadScripts()
         s.connectionId     = q.value(11).toInt();
         list.append(s);
     }
+    q.finish();
     return list;
 }
 
 int DatabaseManager::saveScript(const ScriptConfig &script)
 {
-    QSqlQuery q(m_db);
-    q.prepare("INSERT INTO scripts (name,enabled,trigger_topic,trigger_condition,trigger_value,"
-              "response_topic,response_payload,response_qos,response_retain,delay_ms,connection_id) "
-              "VALUES (:name,:enabled,:ttopic,:tcond,:tval,:rtopic,:rpayload,:rqos,:rretain,:delay,:connid)");
+    QSqlQuery &q = cachedQuery("INSERT INTO scripts (name,enabled,trigger_topic,trigger_condition,trigger_value,"
+                               "response_topic,response_payload,response_qos,response_retain,delay_ms,connection_id) "
+                               "VALUES (:name,:enabled,:ttopic,:tcond,:tval,:rtopic,:rpayload,:rqos,:rretain,:delay,:connid)");
     q.bindValue(":name",     script.name);
     q.bindValue(":enabled",  script.enabled ? 1 : 0);
     q.bindValue(":ttopic",   script.triggerTopic);
@@ -327,11 +744,10 @@ int DatabaseManager::saveScript(const ScriptConfig &script)
 
 bool DatabaseManager::updateScript(const ScriptConfig &script)
 {
-    QSqlQuery q(m_db);
-    q.prepare("UPDATE scripts SET name=:name,enabled=:enabled,trigger_topic=:ttopic,"
-              "trigger_condition=:tcond,trigger_value=:tval,response_topic=:rtopic,"
-              "response_payload=:rpayload,response_qos=:rqos,response_retain=:rretain,"
-              "delay_ms=:delay,connection_id=:connid WHERE id=:id");
+    QSqlQuery &q = cachedQuery("UPDATE scripts SET name=:name,enabled=:enabled,trigger_topic=:ttopic,"
+                               "trigger_condition=:tcond,trigger_value=:tval,response_topic=:rtopic,"
+                               "response_payload=:rpayload,response_qos=:rqos,response_retain=:rretain,"
+                               "delay_ms=:delay,connection_id=:connid WHERE id=:id");
     q.bindValue(":name",     script.name);
     q.bindValue(":enabled",  script.enabled ? 1 : 0);
     q.bindValue(":ttopic",   script.triggerTopic);
@@ -350,8 +766,7 @@ bool DatabaseManager::updateScript(const ScriptConfig &script)
 
 bool DatabaseManager::deleteScript(int id)
 {
-    QSqlQuery q(m_db);
-    q.prepare("DELETE FROM scripts WHERE id=:id");
+    QSqlQuery &q = cachedQuery("DELETE FROM scripts WHERE id=:id");
     q.bindValue(":id", id);
     return q.exec();
 }
@@ -361,8 +776,7 @@ bool DatabaseManager::deleteScript(int id)
 QList<SubscriptionConfig> DatabaseManager::loadSubscriptions(int connectionId)
 {
     QList<SubscriptionConfig> list;
-    QSqlQuery q(m_db);
-    q.prepare("SELECT id,connection_id,topic,qos FROM subscriptions WHERE connection_id=:connid ORDER BY id");
+    QSqlQuery &q = cachedQuery("SELECT id,connection_id,topic,qos FROM subscriptions WHERE connection_id=:connid ORDER BY id");
     q.bindValue(":connid", connectionId);
     if (!q.exec()) { qWarning() << q.lastError().text(); return list; }
     while (q.next()) {
@@ -373,13 +787,13 @@ QList<SubscriptionConfig> DatabaseManager::loadSubscriptions(int connectionId)
         s.qos          = q.value(3).toInt();
         list.append(s);
     }
+    q.finish();
     return list;
 }
 
 int DatabaseManager::saveSubscription(const SubscriptionConfig &sub)
 {
-    QSqlQuery q(m_db);
-    q.prepare("INSERT INTO subscriptions (connection_id,topic,qos) VALUES (:connid,:topic,:qos)");
+    QSqlQuery &q = cachedQuery("INSERT INTO subscriptions (connection_id,topic,qos) VALUES (:connid,:topic,:qos)");
     q.bindValue(":connid", sub.connectionId);
     q.bindValue(":topic",  sub.topic);
     q.bindValue(":qos",    sub.qos);
@@ -389,36 +803,115 @@ int DatabaseManager::saveSubscription(const SubscriptionConfig &sub)
 
 bool DatabaseManager::deleteSubscription(int id)
 {
-    QSqlQuery q(m_db);
-    q.prepare("DELETE FROM subscriptions WHERE id=:id");
+    QSqlQuery &q = cachedQuery("DELETE FROM subscriptions WHERE id=:id");
     q.bindValue(":id", id);
     return q.exec();
 }
 
 // ---- Messages ----
 
-int DatabaseManager::saveMessage(const MessageRecord &msg)
+static const char *kInsertMessageSql =
+    "INSERT INTO messages (connection_id,topic_id,payload,outgoing,retained,timestamp) "
+    "VALUES (:connid,:topicid,:payload,:out,:ret,:ts)";
+
+static void bindMessage(QSqlQuery &q, const MessageRecord &msg, int topicRowId)
 {
-    QSqlQuery q(m_db);
-    q.prepare("INSERT INTO messages (connection_id,topic,payload,outgoing,timestamp) "
-              "VALUES (:connid,:topic,:payload,:out,:ts)");
     q.bindValue(":connid",  msg.connectionId);
-    q.bindValue(":topic",   msg.topic);
+    q.bindValue(":topicid", topicRowId);
     q.bindValue(":payload", msg.payload);
     q.bindValue(":out",     msg.outgoing ? 1 : 0);
-    q.bindValue(":ts",      msg.timestamp.toString(Qt::ISODate));
+    q.bindValue(":ret",     msg.retained ? 1 : 0);
+    q.bindValue(":ts",      msg.timestampMs);
+}
+
+int DatabaseManager::topicRowId(const MessageRecord &msg, QList<int> *added)
+{
+    const int registryId = msg.topicId >= 0 ? msg.topicId
+                                            : TopicRegistry::instance().idFor(msg.topic);
+    // Topics the full registry did not intern are looked up every time
+    const int cached = registryId >= 0 ? m_topicRowIds.value(registryId, -1) : -1;
+    if (cached >= 0)
+        return cached;
+
+    QSqlQuery &insert = cachedQuery("INSERT OR IGNORE INTO topics (name) VALUES (:name)");
+    insert.bindValue(":name", msg.topic);
+    if (!insert.exec()) { qWarning() << insert.lastError().text(); return -1; }
+
+    QSqlQuery &select = cachedQuery("SELECT id FROM topics WHERE name=:name");
+    select.bindValue(":name", msg.topic);
+    if (!select.exec() || !select.next()) { qWarning() << select.lastError().text(); return -1; }
+    const int rowId = select.value(0).toInt();
+    select.finish();
+
+    if (registryId >= 0) {
+        m_topicRowIds.insert(registryId, rowId);
+        if (added)
+            added->append(registryId);
+    }
+    return rowId;
+}
+
+int DatabaseManager::saveMessage(const MessageRecord &msg)
+{
+    const int topicId = topicRowId(msg);
+    if (topicId < 0) return -1;
+    QSqlQuery &q = cachedQuery(kInsertMessageSql);
+    bindMessage(q, msg, topicId);
     if (!q.exec()) { qWarning() << q.lastError().text(); return -1; }
     return q.lastInsertId().toInt();
 }
 
+bool DatabaseManager::saveMessages(const QList<MessageRecord> &msgs)
+{
+    if (msgs.isEmpty())
+        return true;
+    if (!m_db.transaction()) { qWarning() << m_db.lastError().text(); return false; }
+
+    // A rollback also undoes topics inserted in this batch (and their
+    // AUTOINCREMENT ids), so their cache entries must go with them
+    QList<int> addedTopics;
+    auto rollback = [this, &addedTopics]() {
+        m_db.rollback();
+        for (int registryId : addedTopics)
+            m_topicRowIds.remove(registryId);
+    };
+
+    QSqlQuery &q = cachedQuery(kInsertMessageSql);
+    for (const MessageRecord &msg : msgs) {
+        const int topicId = topicRowId(msg, &addedTopics);
+        if (topicId >= 0)
+            bindMessage(q, msg, topicId);
+        if (topicId < 0 || !q.exec()) {
+            qWarning() << q.lastError().text();
+            rollback();
+            return false;
+        }
+    }
+    if (!m_db.commit()) {
+        qWarning() << m_db.lastError().text();
+        rollback();
+        return false;
+    }
+    return true;
+}
+
 QList<MessageRecord> DatabaseManager::loadMessages(int connectionId, int limit)
 {
-    QList<MessageRecord> list;
-    QSqlQuery q(m_db);
     // Return the most-recent 'limit' messages in chronological order (oldest first)
-    q.prepare("SELECT id,connection_id,topic,payload,outgoing,timestamp FROM messages "
-              "WHERE connection_id=:connid ORDER BY id DESC LIMIT :lim");
+    return loadMessagesBefore(connectionId, std::numeric_limits<int>::max(), limit);
+}
+
+QList<MessageRecord> DatabaseManager::loadMessagesBefore(int connectionId, int beforeId, int limit)
+{
+    QList<MessageRecord> list;
+    // Seeks idx_messages_conn_id directly, so every page costs the same
+    // no matter how far back it is (unlike OFFSET)
+    QSqlQuery &q = cachedQuery("SELECT m.id,m.connection_id,t.name,m.payload,m.outgoing,m.retained,m.timestamp "
+                               "FROM messages m JOIN topics t ON t.id = m.topic_id "
+                               "WHERE m.connection_id=:connid AND m.id<:before "
+                               "ORDER BY m.id DESC LIMIT :lim");
     q.bindValue(":connid", connectionId);
+    q.bindValue(":before", beforeId);
     q.bindValue(":lim",    limit);
     if (!q.exec()) { qWarning() << q.lastError().text(); return list; }
 
@@ -426,19 +919,136 @@ QList<MessageRecord> DatabaseManager::loadMessages(int connectionId, int limit)
         MessageRecord m;
         m.id           = q.value(0).toInt();
         m.connectionId = q.value(1).toInt();
-        m.topic        = q.value(2).toString();
-        m.payload      = q.value(3).toString();
+        m.topic        = TopicRegistry::instance().intern(q.value(2).toString(), &m.topicId);
+        m.payload      = q.value(3).toByteArray();
         m.outgoing     = q.value(4).toBool();
-        m.timestamp    = QDateTime::fromString(q.value(5).toString(), Qt::ISODate);
+        m.retained     = q.value(5).toBool();
+        m.timestampMs  = q.value(6).toLongLong();
         list.prepend(m); // prepend to get chronological order
     }
+    q.finish();
     return list;
 }
 
-bool DatabaseManager::deleteMessages(int connectionId)
+QList<int> DatabaseManager::topicRowIdsMatching(const QString &filter)
 {
+    QList<int> ids;
     QSqlQuery q(m_db);
-    q.prepare("DELETE FROM messages WHERE connection_id=:connid");
+    if (!filter.contains('+') && !filter.contains('#')) {
+        q.prepare("SELECT id FROM topics WHERE name=:name");
+        q.bindValue(":name", filter);
+        if (q.exec() && q.next())
+            ids.append(q.value(0).toInt());
+        return ids;
+    }
+
+    // The topics table holds each distinct topic once, so matching them all
+    // against the filter is cheap next to scanning messages
+    TopicFilterTrie trie;
+    trie.insert(filter, 0);
+    if (!q.exec("SELECT id,name FROM topics")) { qWarning() << q.lastError().text(); return ids; }
+    while (q.next()) {
+        if (!trie.match(q.value(1).toString()).isEmpty())
+            ids.append(q.value(0).toInt());
+    }
+    return ids;
+}
+
+QList<MessageRecord> DatabaseManager::searchMessages(const MessageSearchQuery &query)
+{
+    QList<MessageRecord> list;
+
+    // Trigram index needs at least three characters per term
+    QStringList ftsTerms, likeTerms;
+    // Until the history is indexed a MATCH would miss older messages
+    if (m_fullTextPending)
+        refreshFullTextState();
+    const bool useIndex = m_hasFullTextIndex && !m_fullTextPending;
+    for (const QString &term : query.terms.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts)) {
+        if (useIndex && term.size() >= 3)
+            ftsTerms << '"' + QString(term).replace('"', "\"\"") + '"';
+        else
+            likeTerms << term;
+    }
+
+    QStringList where;
+    QVariantList binds;
+    QString from;
+    QString idColumn;
+    if (!ftsTerms.isEmpty()) {
+        // Drive from the index in rowid order so LIMIT stops the scan early
+        from     = "FROM messages_fts JOIN messages m ON m.id = messages_fts.rowid ";
+        idColumn = "messages_fts.rowid";
+        where << "messages_fts MATCH ?";
+        binds << ftsTerms.join(' ');
+    } else {
+        from     = "FROM messages m ";
+        idColumn = "m.id";
+    }
+    if (query.beforeId > 0) {
+        where << idColumn + " < ?";
+        binds << query.beforeId;
+    }
+    if (query.connectionId >= 0) {
+        where << "m.connection_id = ?";
+        binds << query.connectionId;
+    }
+    if (!query.topicFilter.isEmpty()) {
+        const QList<int> topicIds = topicRowIdsMatching(query.topicFilter);
+        if (topicIds.isEmpty())
+            return list;
+        QStringList idText;
+        for (int id : topicIds)
+            idText << QString::number(id);
+        where << "m.topic_id IN (" + idText.join(',') + ")";
+    }
+    if (query.fromMs > 0) {
+        where << "m.timestamp >= ?";
+        binds << query.fromMs;
+    }
+    if (query.toMs > 0) {
+        where << "m.timestamp <= ?";
+        binds << query.toMs;
+    }
+    for (QString term : likeTerms) {
+        term.replace('\\', "\\\\").replace('%', "\\%").replace('_', "\\_");
+        // Payloads are stored as blobs, which LIKE never matches uncast
+        where << "CAST(m.payload AS TEXT) LIKE ? ESCAPE '\\'";
+        binds << '%' + term + '%';
+    }
+
+    QString sql = "SELECT m.id,m.connection_id,t.name,m.payload,m.outgoing,m.retained,m.timestamp "
+                + from + "JOIN topics t ON t.id = m.topic_id ";
+    if (!where.isEmpty())
+        sql += "WHERE " + where.join(" AND ") + ' ';
+    sql += "ORDER BY " + idColumn + " DESC LIMIT ?";
+    binds << qMax(1, query.limit);
+
+    // Shape varies per query, so not worth a slot in the statement cache
+    QSqlQuery q(m_db);
+    q.setForwardOnly(true);
+    if (!q.prepare(sql)) { qWarning() << q.lastError().text(); return list; }
+    for (const QVariant &v : binds)
+        q.addBindValue(v);
+    if (!q.exec()) { qWarning() << q.lastError().text(); return list; }
+
+    while (q.next()) {
+        MessageRecord m;
+        m.id           = q.value(0).toInt();
+        m.connectionId = q.value(1).toInt();
+        m.topic        = TopicRegistry::instance().intern(q.value(2).toString(), &m.topicId);
+        m.payload      = q.value(3).toByteArray();
+        m.outgoing     = q.value(4).toBool();
+        m.retained     = q.value(5).toBool();
+        m.timestampMs  = q.value(6).toLongLong();
+        list.append(m);
+    }
+    return list;
+}
+
+bool DatabaseManager::deleteMessages(int connectionId)
+{
+    QSqlQuery &q = cachedQuery("DELETE FROM messages WHERE connection_id=:connid");
     q.bindValue(":connid", connectionId);
     return q.exec();
 }
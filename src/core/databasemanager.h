@@ -3,9 +3,27 @@
 
 #include <QObject>
 #include <QSqlDatabase>
+#include <QSqlQuery>
 #include <QList>
+#include <QHash>
+#include <unordered_map>
 #include "models.h"
 
+// SQLite PRAGMAs applied on every open(). Profiles trade durability for
+// write throughput: "safe" is SQLite's default rollback journal with
+// synchronous=FULL, "balanced" uses WAL with synchronous=NORMAL (a power
+// loss can drop the last commits but never corrupts), "fast" also turns
+// off syncing entirely.
+struct DatabaseTuning {
+    QString journalMode;   // "DELETE" or "WAL"
+    QString synchronous;   // "FULL", "NORMAL" or "OFF"
+    qint64  mmapSize;      // bytes, 0 disables memory-mapped I/O
+    int     cacheSizeKiB;
+    QString tempStore;     // "DEFAULT" or "MEMORY"
+
+    static DatabaseTuning forProfile(const QString &profile);
+};
+
 class DatabaseManager : public QObject
 {
     Q_OBJECT
@@ -13,8 +31,23 @@ public:
     explicit DatabaseManager(QObject *parent = nullptr);
     ~DatabaseManager();
 
-    bool open(const QString &dbPath = QString());
+    // Each thread that touches the database needs its own connection name
+    bool open(const QString &dbPath = QString(),
+              const QString &connectionName = QStringLiteral("mqtt_assistant_db"));
+    // Read-only connection to a database another connection has already
+    // opened (and migrated); used for long searches off the writer thread
+    bool openReadOnly(const QString &dbPath, const QString &connectionName);
     void close();
+    QString databasePath() const { return m_db.databaseName(); }
+
+    // Re-applies the PRAGMAs immediately if the database is already open,
+    // except journal_mode: SQLite refuses to leave WAL while other
+    // connections are open, so that part takes effect on the next open()
+    void setDurabilityProfile(const QString &profile);
+    // Journal mode in effect ("wal", "delete", ...), empty when closed
+    QString journalMode() const { return m_journalMode; }
+
+    int schemaVersion();
 
     // Connections
     QList<MqttConnectionConfig> loadConnections();
@@ -41,12 +74,44 @@ public:
 
     // Messages
     int saveMessage(const MessageRecord &msg);
+    bool saveMessages(const QList<MessageRecord> &msgs); // one transaction
     QList<MessageRecord> loadMessages(int connectionId, int limit = 100);
+    // Keyset page: the 'limit' newest messages with id < beforeId, oldest first
+    QList<MessageRecord> loadMessagesBefore(int connectionId, int beforeId, int limit = 100);
     bool deleteMessages(int connectionId);
 
+    // Newest matches first; page on by passing the last id as beforeId.
+    // Terms of three or more characters use the FTS5 trigram index when the
+    // SQLite build has one and it covers the whole history; shorter terms
+    // (or all, without FTS5 or during the backfill) use LIKE.
+    QList<MessageRecord> searchMessages(const MessageSearchQuery &query);
+    bool hasFullTextIndex() const { return m_hasFullTextIndex; }
+    // Messages stored before the index was created still need indexing
+    bool fullTextBackfillPending() const { return m_fullTextPending; }
+    // Indexes the next chunkRows ids of that history in one transaction.
+    // Returns the percentage done (100 once complete) or -1 on error.
+    int backfillFullTextIndex(int chunkRows);
+
 private:
     QSqlDatabase m_db;
-    bool createTables();
+    DatabaseTuning m_tuning;
+    QString        m_journalMode;
+    // SQL text -> prepared statement, so each statement is compiled once per
+    // connection (unordered_map keeps references stable across inserts)
+    std::unordered_map<QString, QSqlQuery> m_statements;
+    QHash<int, int> m_topicRowIds; // TopicRegistry id -> topics.id; bounded by kMaxTopics
+    bool m_hasFullTextIndex = false;
+    bool m_fullTextPending  = false;
+
+    bool migrate(); // applies pending schema_version steps in order
+    void refreshFullTextState();
+    void ensureFullTextIndex(); // retries the FTS5 table migration 6 could not create
+    void applyTuning(bool includeJournalMode);
+    QSqlQuery &cachedQuery(const QString &sql);
+    // Inserts the topic if new; newly cached registry ids are appended to
+    // 'added' so a rolled-back transaction can forget them
+    int topicRowId(const MessageRecord &msg, QList<int> *added = nullptr);
+    QList<int> topicRowIdsMatching(const QString &filter);
 };
 
 #endif // DATABASEMANAGER_H
@@ -0,0 +1,130 @@
+#include "headlessrunner.h"
+#include "persistenceworker.h"
+#include "mqttclient.h"
+#include "scriptengine.h"
+#include "metatypes.h"
+#include "logger.h"
+#include <QThread>
+#include <QDebug>
+
+HeadlessRunner::HeadlessRunner(QObject *parent)
+    : QObject(parent)
+    , m_persistence(nullptr)
+    , m_persistenceThread(nullptr)
+    , m_recorded(0)
+{
+    connect(&m_ingestor, &MessageIngestor::messagesReady, this, &HeadlessRunner::onMessagesReady);
+}
+
+HeadlessRunner::~HeadlessRunner()
+{
+    stop();
+}
+
+bool HeadlessRunner::start(const QString &dbPath, const QString &durabilityProfile,
+                           const QList<int> &connectionIds)
+{
+    registerCoreMetaTypes();
+
+    m_db.setDurabilityProfile(durabilityProfile);
+    if (!m_db.open(dbPath)) {
+        qWarning() << "Failed to open database:" << dbPath;
+        return false;
+    }
+
+    QList<MqttConnectionConfig> selected;
+    for (const MqttConnectionConfig &config : m_db.loadConnections()) {
+        if (connectionIds.isEmpty() || connectionIds.contains(config.id))
+            selected.append(config);
+    }
+    if (selected.isEmpty()) {
+        qWarning() << "No matching connections in" << dbPath;
+        return false;
+    }
+
+    // Same write-behind path as the GUI: batched on a thread of its own
+    m_persistence = new PersistenceWorker();
+    m_persistenceThread = new QThread(this);
+    m_persistence->moveToThread(m_persistenceThread);
+    connect(m_persistenceThread, &QThread::finished, m_persistence, &QObject::deleteLater);
+    m_persistenceThread->start();
+    QMetaObject::invokeMethod(m_persistence, "open", Qt::QueuedConnection,
+                              Q_ARG(QString, dbPath), Q_ARG(QString, durabilityProfile));
+
+    const QList<ScriptConfig> scripts = m_db.loadScripts();
+    for (const MqttConnectionConfig &config : selected)
+        startConnection(config, scripts);
+
+    qInfo().noquote() << QString("Running %1 connection(s) on %2 I/O thread(s)")
+                             .arg(selected.size()).arg(m_connectionManager.threadCount());
+    return true;
+}
+
+void HeadlessRunner::startConnection(const MqttConnectionConfig &config,
+                                     const QList<ScriptConfig> &scripts)
+{
+    const int id = config.id;
+    MqttClient *client = m_connectionManager.create(id);
+
+    QList<ScriptConfig> own;
+    for (const ScriptConfig &s : scripts) {
+        if (s.connectionId == id || s.connectionId == -1)
+            own.append(s);
+    }
+    m_connectionManager.scriptEngine(id)->setScripts(own);
+    m_ingestor.attach(id, client);
+
+    const QString name = config.name;
+    connect(client, &MqttClient::connected, this, [name]() {
+        qInfo().noquote() << "[" + name + "] connected";
+    }, Qt::QueuedConnection);
+    connect(client, &MqttClient::disconnected, this, [name]() {
+        qInfo().noquote() << "[" + name + "] disconnected";
+    }, Qt::QueuedConnection);
+    connect(client, &MqttClient::errorOccurred, this, [name](const QString &msg) {
+        qWarning().noquote() << "[" + name + "] error:" << msg;
+    }, Qt::QueuedConnection);
+
+    // The client subscribes by itself after every (re)connect
+    QMetaObject::invokeMethod(client, "setSubscriptions", Qt::QueuedConnection,
+                              Q_ARG(QList<SubscriptionConfig>, m_db.loadSubscriptions(id)));
+    QMetaObject::invokeMethod(client, "connectToHost", Qt::QueuedConnection,
+                              Q_ARG(MqttConnectionConfig, config));
+    LOG_INFO("headless", QString("Started connection %1 (%2 scripts)").arg(id).arg(own.size()));
+}
+
+void HeadlessRunner::stop()
+{
+    if (!m_persistenceThread)
+        return;
+
+    for (int id : m_connectionManager.connectionIds()) {
+        m_ingestor.detach(id);
+        m_connectionManager.remove(id);
+    }
+
+    // Flush queued messages before the writer thread goes away
+    QMetaObject::invokeMethod(m_persistence, "close", Qt::BlockingQueuedConnection);
+    m_persistenceThread->quit();
+    m_persistenceThread->wait();
+    m_persistenceThread = nullptr;
+    m_persistence = nullptr;
+    m_db.close();
+
+    qInfo().noquote() << QString("Stopped, %1 message(s) recorded").arg(m_recorded);
+}
+
+void HeadlessRunner::onMessagesReady(int connectionId, const QList<MessageRecord> &messages)
+{
+    Q_UNUSED(connectionId)
+    if (!m_persistence)
+        return;
+    // Do not persist retained messages to avoid duplicate history on reconnect
+    for (const MessageRecord &msg : messages) {
+        if (msg.retained)
+            continue;
+        if (!m_persistence->enqueue(msg))
+            m_db.saveMessage(msg);
+        ++m_recorded;
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef HEADLESSRUNNER_H
+#define HEADLESSRUNNER_H
+
+#include <QObject>
+#include <QList>
+#include "databasemanager.h"
+#include "messageingestor.h"
+#include "connectionmanager.h"
+#include "models.h"
+
+class QThread;
+class PersistenceWorker;
+
+/**
+ * The GUI-free core wiring: loads connections, subscriptions and scripts
+ * from the database, connects every selected broker through a
+ * ConnectionManager, runs its scripts, and records received messages
+ * through the write-behind PersistenceWorker. Needs only QtCore, QtSql,
+ * QtNetwork and QtMqtt, so it can run under a QCoreApplication.
+ */
+class HeadlessRunner : public QObject
+{
+    Q_OBJECT
+public:
+    explicit HeadlessRunner(QObject *parent = nullptr);
+    ~HeadlessRunner();
+
+    // connectionIds empty = every saved connection. Returns false if the
+    // database cannot be opened or nothing is left to run.
+    bool start(const QString &dbPath, const QString &durabilityProfile,
+               const QList<int> &connectionIds = QList<int>());
+    void stop(); // disconnects and flushes the message writer
+
+    int connectionCount() const { return m_connectionManager.count(); }
+    quint64 recordedCount() const { return m_recorded; }
+
+private slots:
+    void onMessagesReady(int connectionId, const QList<MessageRecord> &messages);
+
+private:
+    void startConnection(const MqttConnectionConfig &config, const QList<ScriptConfig> &scripts);
+
+    DatabaseManager    m_db;
+    PersistenceWorker *m_persistence;
+    QThread           *m_persistenceThread;
+    MessageIngestor    m_ingestor;
+    // Declared after m_ingestor so clients are gone before the ingestor is
+    ConnectionManager  m_connectionManager;
+    quint64            m_recorded;
+};
+
+#endif // HEADLESSRUNNER_H
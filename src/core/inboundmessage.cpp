@@ -0,0 +1,34 @@
+#include "inboundmessage.h"
+#include "topicregistry.h"
+#include <QDateTime>
+#include <chrono>
+
+InboundMessagePool::InboundMessagePool()
+    : m_resource(std::make_shared<std::pmr::synchronized_pool_resource>())
+{
+}
+
+InboundMessagePtr InboundMessagePool::create(const QString &topic, const QByteArray &payload,
+                                             int qos, bool retained, int messageId)
+{
+    const qint64 monoNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    const CachedTopic &interned = internTopic(topic);
+    return std::allocate_shared<InboundMessage>(
+        Allocator<InboundMessage>(m_resource),
+        interned.canonical, interned.id, payload, QDateTime::currentMSecsSinceEpoch(), monoNs,
+        qos, retained, messageId);
+}
+
+const InboundMessagePool::CachedTopic &InboundMessagePool::internTopic(const QString &topic)
+{
+    auto it = m_topics.constFind(topic);
+    if (it != m_topics.constEnd())
+        return it.value();
+    // Topics are usually a small, stable set; start over if one is not
+    if (m_topics.size() >= kMaxCachedTopics)
+        m_topics.clear();
+    CachedTopic entry;
+    entry.canonical = TopicRegistry::instance().intern(topic, &entry.id);
+    return m_topics.insert(entry.canonical, entry).value();
+}
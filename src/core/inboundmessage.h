@@ -0,0 +1,92 @@
+#ifndef INBOUNDMESSAGE_H
+#define INBOUNDMESSAGE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QMetaType>
+#include <QString>
+#include <memory>
+#include <memory_resource>
+
+/**
+ * A received message as handed to every consumer (ingestor, script engine).
+ * Immutable and reference-counted: all consumers share one instance, and
+ * topic/payload share their data with the QMqttMessage they came from.
+ */
+struct InboundMessage {
+    QString    topic;       // canonical TopicRegistry string; equal topics share data
+    int        topicId;     // TopicRegistry id
+    QByteArray payload;     // raw bytes, never decoded here
+    qint64     receivedMs;  // wall clock, ms since the Unix epoch
+    qint64     receivedNs;  // monotonic clock, for latency measurements
+    int        qos;
+    bool       retained;
+    int        messageId;   // MQTT packet id; 0 for QoS 0
+
+    InboundMessage(const QString &t, int tid, const QByteArray &p, qint64 wallMs, qint64 monoNs,
+                   int q, bool r, int id)
+        : topic(t), topicId(tid), payload(p), receivedMs(wallMs), receivedNs(monoNs),
+          qos(q), retained(r), messageId(id) {}
+};
+
+using InboundMessagePtr = std::shared_ptr<const InboundMessage>;
+
+Q_DECLARE_METATYPE(InboundMessagePtr)
+
+/**
+ * Per-connection factory for InboundMessage. Messages and their shared_ptr
+ * control blocks come from one pooled allocation each, so a steady stream
+ * reuses memory instead of hitting the heap. The pool stays alive until the
+ * last message allocated from it is released, wherever that happens.
+ * create() must be called from one thread (the client's); releasing a
+ * message is safe from any thread.
+ */
+class InboundMessagePool
+{
+public:
+    static const int kMaxCachedTopics = 4096;
+
+    InboundMessagePool();
+
+    InboundMessagePtr create(const QString &topic, const QByteArray &payload,
+                             int qos, bool retained, int messageId);
+
+private:
+    // Keeps the pool alive from inside every control block allocated from it
+    template <typename T>
+    struct Allocator {
+        using value_type = T;
+
+        explicit Allocator(std::shared_ptr<std::pmr::memory_resource> r) : resource(std::move(r)) {}
+        template <typename U>
+        Allocator(const Allocator<U> &other) : resource(other.resource) {}
+
+        T *allocate(std::size_t n)
+        {
+            return static_cast<T *>(resource->allocate(n * sizeof(T), alignof(T)));
+        }
+        void deallocate(T *p, std::size_t n)
+        {
+            resource->deallocate(p, n * sizeof(T), alignof(T));
+        }
+        template <typename U>
+        bool operator==(const Allocator<U> &other) const { return resource == other.resource; }
+        template <typename U>
+        bool operator!=(const Allocator<U> &other) const { return resource != other.resource; }
+
+        std::shared_ptr<std::pmr::memory_resource> resource;
+    };
+
+    struct CachedTopic {
+        QString canonical;
+        int     id;
+    };
+
+    const CachedTopic &internTopic(const QString &topic);
+
+    std::shared_ptr<std::pmr::memory_resource> m_resource;
+    // Lock-free front for TopicRegistry; creating thread only
+    QHash<QString, CachedTopic> m_topics;
+};
+
+#endif // INBOUNDMESSAGE_H
@@ -0,0 +1,158 @@
+#include "loadgenerator.h"
+#include "mqttclient.h"
+#include <QTimer>
+
+LoadGenerator::LoadGenerator(MqttClient *client, QObject *parent)
+    : QObject(parent)
+    , m_client(client)
+    , m_tickTimer(new QTimer(this))
+    , m_statsTimer(new QTimer(this))
+{
+    m_tickTimer->setTimerType(Qt::PreciseTimer);
+    m_tickTimer->setInterval(kTickMs);
+    m_statsTimer->setInterval(kStatsIntervalMs);
+    connect(m_tickTimer,  &QTimer::timeout, this, &LoadGenerator::onTick);
+    connect(m_statsTimer, &QTimer::timeout, this, &LoadGenerator::reportStats);
+    connect(m_client, &MqttClient::messageSent, this, &LoadGenerator::onMessageSent);
+    // A reconnect (including one for new settings, which emits no
+    // disconnected()) starts a new session
+    connect(m_client, &MqttClient::disconnected, this, &LoadGenerator::onConnectionReset);
+    connect(m_client, &MqttClient::connected, this, &LoadGenerator::onConnectionReset);
+}
+
+void LoadGenerator::start(const LoadProfile &profile)
+{
+    m_profile = profile;
+    m_profile.rate      = qBound(0.0, profile.rate, double(kMaxRate));
+    m_profile.startRate = qBound(0.0, profile.startRate, double(kMaxRate));
+    m_profile.rampMs          = qMax(1, profile.rampMs);
+    m_profile.burstSize       = qMax(1, profile.burstSize);
+    m_profile.burstIntervalMs = qMax(1, profile.burstIntervalMs);
+
+    m_template = MessageTemplate(m_profile.payload);
+    m_payload  = m_template.isLiteral() ? m_profile.payload.toUtf8() : QByteArray();
+
+    m_inFlight.clear();
+    m_stats = LoadStats();
+    m_stats.running    = true;
+    m_sentAtLastReport = 0;
+    m_latencySumNs = m_latencyMaxNs = m_latencyCount = 0;
+
+    m_clock.start();
+    m_tickTimer->start();
+    m_statsTimer->start();
+}
+
+void LoadGenerator::stop()
+{
+    if (!m_stats.running)
+        return;
+    m_tickTimer->stop();
+    m_statsTimer->stop();
+    m_stats.running = false;
+    reportStats();
+    emit finished();
+}
+
+qint64 LoadGenerator::expectedCount(qint64 elapsedNs) const
+{
+    const double t = elapsedNs / 1e9;
+    switch (m_profile.shape) {
+    case LoadProfile::Burst: {
+        // A full burst at t = 0, then one every burstIntervalMs
+        const qint64 bursts = elapsedNs / (qint64(m_profile.burstIntervalMs) * 1000000) + 1;
+        return bursts * m_profile.burstSize;
+    }
+    case LoadProfile::Ramp: {
+        // Integral of a rate rising linearly from startRate to rate over the ramp
+        const double r0 = m_profile.startRate;
+        const double r1 = m_profile.rate;
+        const double ramp = m_profile.rampMs / 1000.0;
+        if (t < ramp)
+            return qint64(r0 * t + (r1 - r0) * t * t / (2 * ramp));
+        return qint64((r0 + r1) * ramp / 2 + r1 * (t - ramp));
+    }
+    case LoadProfile::Constant:
+        break;
+    }
+    return qint64(m_profile.rate * t);
+}
+
+void LoadGenerator::onTick()
+{
+    if (!m_client) {
+        stop();
+        return;
+    }
+    const qint64 elapsedNs = m_clock.nsecsElapsed();
+    if (m_profile.durationMs > 0 && elapsedNs >= qint64(m_profile.durationMs) * 1000000) {
+        stop();
+        return;
+    }
+
+    qint64 due = expectedCount(elapsedNs) - m_stats.sent - m_stats.failed;
+    due = qMin<qint64>(due, kMaxPerTick);
+    if (m_profile.qos > 0)
+        due = qMin<qint64>(due, kMaxInFlight - m_inFlight.size());
+
+    const MessageTemplate::Context context{m_profile.topic, QString(), QByteArray(), false};
+    for (qint64 i = 0; i < due; ++i) {
+        const QByteArray payload = m_template.isLiteral()
+            ? m_payload : m_template.render(context).toUtf8();
+
+        const qint64 sentAt = m_clock.nsecsElapsed();
+        const qint32 id = m_client->publishRaw(m_profile.topic, payload,
+                                               m_profile.qos, m_profile.retain);
+        if (id < 0) {
+            ++m_stats.failed;
+            continue;
+        }
+        ++m_stats.sent;
+        if (m_profile.qos > 0)
+            m_inFlight.insert(id, sentAt);
+        else
+            recordLatency(m_clock.nsecsElapsed() - sentAt);
+    }
+}
+
+void LoadGenerator::onMessageSent(qint32 id)
+{
+    auto it = m_inFlight.find(id);
+    if (it == m_inFlight.end())
+        return; // not ours, or from an earlier run
+    recordLatency(m_clock.nsecsElapsed() - it.value());
+    m_inFlight.erase(it);
+}
+
+void LoadGenerator::onConnectionReset()
+{
+    // Acks for publishes of the old session never arrive; without this they
+    // would hold kMaxInFlight slots for the rest of the run
+    const qint64 lost = m_inFlight.size();
+    if (lost == 0)
+        return;
+    m_inFlight.clear();
+    m_stats.sent       -= lost;
+    m_stats.failed     += lost;
+    m_sentAtLastReport -= lost; // they were published; keep the rate as it was
+}
+
+void LoadGenerator::recordLatency(qint64 latencyNs)
+{
+    m_latencySumNs += latencyNs;
+    m_latencyMaxNs  = qMax(m_latencyMaxNs, latencyNs);
+    ++m_latencyCount;
+}
+
+void LoadGenerator::reportStats()
+{
+    const qint64 sentSinceLast = m_stats.sent - m_sentAtLastReport;
+    m_stats.achievedRate = sentSinceLast * 1000.0 / kStatsIntervalMs;
+    m_stats.avgLatencyMs = m_latencyCount > 0 ? m_latencySumNs / 1e6 / m_latencyCount : 0;
+    m_stats.maxLatencyMs = m_latencyMaxNs / 1e6;
+    m_stats.inFlight     = m_inFlight.size();
+
+    m_sentAtLastReport = m_stats.sent;
+    m_latencySumNs = m_latencyMaxNs = m_latencyCount = 0;
+    emit statsUpdated(m_stats);
+}
@@ -0,0 +1,104 @@
+#ifndef LOADGENERATOR_H
+#define LOADGENERATOR_H
+
+#include <QObject>
+#include <QHash>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QMetaType>
+#include "messagetemplate.h"
+
+class MqttClient;
+class QTimer;
+
+struct LoadProfile {
+    enum Shape { Constant, Burst, Ramp };
+
+    Shape   shape;
+    QString topic;
+    QString payload;         // may use {{timestamp}} / {{topic}}
+    int     qos;
+    bool    retain;
+    double  rate;            // msgs/s; Ramp: rate reached at the end of the ramp
+    double  startRate;       // Ramp: msgs/s at start
+    int     rampMs;          // Ramp: time to go from startRate to rate
+    int     burstSize;       // Burst: messages per burst
+    int     burstIntervalMs; // Burst: time between bursts
+    int     durationMs;      // 0 = until stopped
+
+    LoadProfile()
+        : shape(Constant), qos(0), retain(false), rate(1000), startRate(0),
+          rampMs(10000), burstSize(1000), burstIntervalMs(1000), durationMs(0) {}
+};
+
+struct LoadStats {
+    qint64 sent;         // total published since start
+    qint64 failed;       // publish() refused, or QoS 1/2 lost with the connection
+    double achievedRate; // msgs/s over the last report interval
+    double avgLatencyMs; // QoS 0: local publish time; QoS 1/2: until broker ack
+    double maxLatencyMs;
+    int    inFlight;     // QoS 1/2 publishes not yet acknowledged
+    bool   running;
+
+    LoadStats()
+        : sent(0), failed(0), achievedRate(0), avgLatencyMs(0),
+          maxLatencyMs(0), inFlight(0), running(false) {}
+};
+
+Q_DECLARE_METATYPE(LoadProfile)
+Q_DECLARE_METATYPE(LoadStats)
+
+/**
+ * Publishes a command at a target rate for load testing. Lives on the
+ * client's thread and calls MqttClient::publishRaw() directly, so there is
+ * no per-message event hop. Pacing is computed from the absolute time since
+ * start (not from tick counts), so timer jitter never accumulates into
+ * drift; each tick publishes however many messages the profile says are due.
+ */
+class LoadGenerator : public QObject
+{
+    Q_OBJECT
+public:
+    static const int kMaxRate         = 50000;
+    static const int kTickMs          = 1;
+    static const int kMaxPerTick      = 5000;  // bounds catch-up after a stall
+    static const int kMaxInFlight     = 20000; // QoS 1/2 back-pressure
+    static const int kStatsIntervalMs = 250;
+
+    explicit LoadGenerator(MqttClient *client, QObject *parent = nullptr);
+
+public slots:
+    void start(const LoadProfile &profile);
+    void stop();
+
+signals:
+    void statsUpdated(const LoadStats &stats);
+    void finished();
+
+private slots:
+    void onTick();
+    void onMessageSent(qint32 id);
+    void onConnectionReset();
+    void reportStats();
+
+private:
+    qint64 expectedCount(qint64 elapsedNs) const;
+    void recordLatency(qint64 latencyNs);
+
+    QPointer<MqttClient> m_client; // deleted under us when the connection is removed
+    QTimer         *m_tickTimer;
+    QTimer         *m_statsTimer;
+    LoadProfile     m_profile;
+    MessageTemplate m_template;
+    QByteArray      m_payload;  // pre-encoded when the template is literal
+    QElapsedTimer   m_clock;
+
+    QHash<qint32, qint64> m_inFlight; // packet id -> send time (ns)
+    LoadStats m_stats;
+    qint64    m_sentAtLastReport = 0;
+    qint64    m_latencySumNs     = 0;
+    qint64    m_latencyMaxNs     = 0;
+    qint64    m_latencyCount     = 0;
+};
+
+#endif // LOADGENERATOR_H
@@ -0,0 +1,202 @@
+#include "logger.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QThread>
+
+static const char *levelName(LogLevel level)
+{
+    switch (level) {
+    case LogLevel::Trace:   return "TRACE";
+    case LogLevel::Debug:   return "DEBUG";
+    case LogLevel::Info:    return "INFO ";
+    case LogLevel::Warning: return "WARN ";
+    case LogLevel::Error:   return "ERROR";
+    default:                return "?    ";
+    }
+}
+
+Logger &Logger::instance()
+{
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger()
+    : m_queue(kQueueCapacity)
+{
+}
+
+Logger::~Logger()
+{
+    stop();
+}
+
+LogLevel Logger::levelFromString(const QString &name, LogLevel fallback)
+{
+    const QString n = name.trimmed().toLower();
+    if (n == "trace")   return LogLevel::Trace;
+    if (n == "debug")   return LogLevel::Debug;
+    if (n == "info")    return LogLevel::Info;
+    if (n == "warning") return LogLevel::Warning;
+    if (n == "error")   return LogLevel::Error;
+    if (n == "off")     return LogLevel::Off;
+    return fallback;
+}
+
+bool Logger::start(const QString &filePath, qint64 maxFileBytes, int maxFiles)
+{
+    if (m_running.load(std::memory_order_acquire))
+        return true;
+
+    m_filePath     = filePath;
+    m_maxFileBytes = qMax<qint64>(64 * 1024, maxFileBytes);
+    m_maxFiles     = qMax(1, maxFiles);
+
+    QFile probe(m_filePath);
+    if (!probe.open(QIODevice::Append)) {
+        qWarning() << "Failed to open log file:" << m_filePath << probe.errorString();
+        return false;
+    }
+    probe.close();
+
+    m_running.store(true, std::memory_order_release);
+    m_thread = QThread::create([this]() { run(); });
+    m_thread->setObjectName("Logger");
+    m_thread->start(QThread::LowPriority);
+    return true;
+}
+
+void Logger::stop()
+{
+    if (!m_running.exchange(false, std::memory_order_acq_rel))
+        return;
+    wake();
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+}
+
+// ---- Caller side (any thread) ----
+
+void Logger::write(LogLevel level, const char *category, QString message)
+{
+    if (!m_running.load(std::memory_order_relaxed))
+        return;
+
+    Entry entry;
+    entry.timeMs   = QDateTime::currentMSecsSinceEpoch();
+    entry.level    = level;
+    entry.category = category;
+    entry.threadId = reinterpret_cast<quintptr>(QThread::currentThreadId());
+    entry.message  = std::move(message);
+
+    if (!m_queue.tryPush(std::move(entry))) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    // Errors go out promptly; everything else waits for the next flush tick
+    // unless the ring is filling up
+    if (level >= LogLevel::Error || m_queue.size() > m_queue.capacity() / 2)
+        wake();
+}
+
+QString LogRateLimiter::filter(const QString &message)
+{
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    QMutexLocker locker(&m_mutex);
+    auto it = m_states.find(message);
+    if (it == m_states.end()) {
+        // Bounded per site; forgetting old messages only costs a repeat line
+        if (m_states.size() >= kMaxMessages)
+            m_states.clear();
+        it = m_states.insert(message, State());
+    } else if (nowMs - it->lastLoggedMs < kIntervalMs) {
+        ++it->suppressed;
+        return QString();
+    }
+
+    QString text = message;
+    if (it->suppressed > 0)
+        text += QString(" (repeated %1 times)").arg(it->suppressed);
+    it->lastLoggedMs = nowMs;
+    it->suppressed   = 0;
+    return text;
+}
+
+void Logger::wake()
+{
+    QMutexLocker locker(&m_wakeMutex);
+    m_wakeCondition.wakeOne();
+}
+
+// ---- Writer thread ----
+
+void Logger::run()
+{
+    QFile file(m_filePath);
+    file.open(QIODevice::Append);
+    qint64 written = file.size();
+    quint64 reportedDrops = 0;
+    QByteArray buffer;
+
+    auto writeOut = [&]() {
+        if (buffer.isEmpty())
+            return;
+        if (written > 0 && written + buffer.size() > m_maxFileBytes) {
+            // Rotate: file.(N-1) -> file.N, ..., file -> file.1
+            file.close();
+            QFile::remove(m_filePath + "." + QString::number(m_maxFiles));
+            for (int i = m_maxFiles - 1; i >= 1; --i)
+                QFile::rename(m_filePath + "." + QString::number(i),
+                              m_filePath + "." + QString::number(i + 1));
+            QFile::rename(m_filePath, m_filePath + ".1");
+            file.open(QIODevice::Append);
+            written = 0;
+        }
+        written += file.write(buffer);
+        buffer.clear();
+    };
+
+    for (;;) {
+        // Read the flag before draining so the last pass sees every entry
+        // pushed before stop()
+        const bool running = m_running.load(std::memory_order_acquire);
+
+        Entry entry;
+        while (m_queue.tryPop(entry)) {
+            buffer += QDateTime::fromMSecsSinceEpoch(entry.timeMs)
+                          .toString("yyyy-MM-dd hh:mm:ss.zzz").toLatin1();
+            buffer += ' ';
+            buffer += levelName(entry.level);
+            buffer += " [";
+            buffer += entry.category ? entry.category : "-";
+            buffer += "] (";
+            buffer += QByteArray::number(static_cast<qulonglong>(entry.threadId), 16);
+            buffer += ") ";
+            buffer += entry.message.toUtf8();
+            buffer += '\n';
+            if (buffer.size() >= 64 * 1024)
+                writeOut();
+        }
+
+        const quint64 drops = m_dropped.load(std::memory_order_relaxed);
+        if (drops != reportedDrops) {
+            buffer += QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss.zzz").toLatin1();
+            buffer += " WARN  [log] " + QByteArray::number(drops - reportedDrops)
+                    + " entries dropped (queue full)\n";
+            reportedDrops = drops;
+        }
+
+        writeOut();
+        file.flush();
+
+        if (!running)
+            break;
+
+        QMutexLocker locker(&m_wakeMutex);
+        if (m_running.load(std::memory_order_acquire) && m_queue.size() == 0)
+            m_wakeCondition.wait(&m_wakeMutex, kFlushIntervalMs);
+    }
+    file.close();
+}
@@ -0,0 +1,136 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <QString>
+#include <QHash>
+#include <QMutex>
+#include <QWaitCondition>
+#include <atomic>
+#include "mpscqueue.h"
+
+class QThread;
+
+enum class LogLevel : int { Trace = 0, Debug, Info, Warning, Error, Off };
+
+/**
+ * Process-wide asynchronous log. Callers only stamp the entry and push it
+ * into a lock-free ring; a background thread formats the lines and appends
+ * them to the log file, rotating it once it exceeds the configured size
+ * (file -> file.1 -> ... -> file.N). When the ring is full entries are
+ * dropped and counted rather than blocking the caller.
+ *
+ * Use the LOG_* macros: they check the level before the message is built,
+ * and LOG_TRACE compiles to nothing unless MQTT_LOG_TRACE is defined.
+ * LOG_*_LIMITED variants collapse repeats of the same message from one call
+ * site (see LogRateLimiter) for paths that can fire in bursts.
+ */
+class Logger
+{
+public:
+    static Logger &instance();
+
+    bool start(const QString &filePath, qint64 maxFileBytes = kDefaultMaxFileBytes,
+               int maxFiles = kDefaultMaxFiles);
+    void stop(); // writes out everything still queued
+
+    void setLevel(LogLevel level) { m_level.store(static_cast<int>(level), std::memory_order_relaxed); }
+    LogLevel level() const { return static_cast<LogLevel>(m_level.load(std::memory_order_relaxed)); }
+    bool isEnabled(LogLevel level) const
+    {
+        return static_cast<int>(level) >= m_level.load(std::memory_order_relaxed);
+    }
+
+    // category must be a string literal (only the pointer is queued)
+    void write(LogLevel level, const char *category, QString message);
+    quint64 droppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    static LogLevel levelFromString(const QString &name, LogLevel fallback = LogLevel::Info);
+
+    static const qint64 kDefaultMaxFileBytes = 4 * 1024 * 1024;
+    static const int    kDefaultMaxFiles     = 3;
+
+private:
+    struct Entry {
+        qint64      timeMs   = 0;
+        LogLevel    level    = LogLevel::Info;
+        const char *category = nullptr;
+        quintptr    threadId = 0;
+        QString     message;
+    };
+
+    Logger();
+    ~Logger();
+    Q_DISABLE_COPY(Logger)
+
+    void run();
+    void wake();
+
+    static const int kQueueCapacity   = 8192;
+    static const int kFlushIntervalMs = 100;
+
+    MpscQueue<Entry>     m_queue;
+    std::atomic<int>     m_level{static_cast<int>(LogLevel::Info)};
+    std::atomic<bool>    m_running{false};
+    std::atomic<quint64> m_dropped{0};
+
+    QThread       *m_thread = nullptr;
+    QMutex         m_wakeMutex;
+    QWaitCondition m_wakeCondition;
+    QString        m_filePath;
+    qint64         m_maxFileBytes = kDefaultMaxFileBytes;
+    int            m_maxFiles     = kDefaultMaxFiles;
+};
+
+/**
+ * Per-call-site repeat filter. The first occurrence of a message is logged;
+ * identical messages within kIntervalMs after it are only counted, and the
+ * next one logged afterwards carries "(repeated N times)". Thread-safe.
+ */
+class LogRateLimiter
+{
+public:
+    static const int kIntervalMs   = 5000;
+    static const int kMaxMessages  = 256; // distinct messages tracked per site
+
+    // Returns the text to log, or a null string if this repeat is swallowed
+    QString filter(const QString &message);
+
+private:
+    struct State {
+        qint64 lastLoggedMs = 0;
+        int    suppressed   = 0;
+    };
+
+    QMutex                m_mutex;
+    QHash<QString, State> m_states;
+};
+
+#define LOG_AT(level, category, message)                                   \
+    do {                                                                   \
+        if (Logger::instance().isEnabled(level))                           \
+            Logger::instance().write(level, category, message);            \
+    } while (0)
+
+#define LOG_AT_LIMITED(level, category, message)                           \
+    do {                                                                   \
+        if (Logger::instance().isEnabled(level)) {                         \
+            static LogRateLimiter logLimiter_;                             \
+            QString logText_ = logLimiter_.filter(message);                \
+            if (!logText_.isNull())                                        \
+                Logger::instance().write(level, category, std::move(logText_)); \
+        }                                                                  \
+    } while (0)
+
+#ifdef MQTT_LOG_TRACE
+#define LOG_TRACE(category, message) LOG_AT(LogLevel::Trace, category, message)
+#else
+#define LOG_TRACE(category, message) do {} while (0)
+#endif
+#define LOG_DEBUG(category, message)   LOG_AT(LogLevel::Debug, category, message)
+#define LOG_INFO(category, message)    LOG_AT(LogLevel::Info, category, message)
+#define LOG_WARNING(category, message) LOG_AT(LogLevel::Warning, category, message)
+#define LOG_ERROR(category, message)   LOG_AT(LogLevel::Error, category, message)
+#define LOG_WARNING_LIMITED(category, message) LOG_AT_LIMITED(LogLevel::Warning, category, message)
+#define LOG_ERROR_LIMITED(category, message)   LOG_AT_LIMITED(LogLevel::Error, category, message)
+
+#endif // LOGGER_H
@@ -0,0 +1,95 @@
+#include "messageingestor.h"
+#include "mqttclient.h"
+#include "logger.h"
+
+MessageIngestor::MessageIngestor(QObject *parent)
+    : QObject(parent)
+{
+    m_frameTimer.setSingleShot(true);
+    m_frameTimer.setInterval(kFrameIntervalMs);
+    connect(&m_frameTimer, &QTimer::timeout, this, &MessageIngestor::drain);
+}
+
+MessageIngestor::~MessageIngestor()
+{
+    // No final drain: receivers may already be half destroyed
+    for (const auto &channel : m_channels)
+        disconnect(channel->connection);
+}
+
+void MessageIngestor::attach(int connectionId, MqttClient *client)
+{
+    detach(connectionId);
+
+    auto channel = std::make_shared<Channel>(connectionId);
+    // Runs on the client's thread: build the record and push, nothing else.
+    // The lambda holds its own reference so detach() cannot free the queue
+    // under a producer that is mid-push.
+    channel->connection = connect(client, &MqttClient::messageReceived, this,
+        [this, channel](const InboundMessagePtr &message) {
+            MessageRecord msg;
+            msg.connectionId = channel->connectionId;
+            msg.topic        = message->topic;
+            msg.topicId      = message->topicId;
+            msg.payload      = message->payload;
+            msg.outgoing     = false;
+            msg.retained     = message->retained;
+            msg.timestampMs  = message->receivedMs;
+            if (!channel->queue.tryPush(std::move(msg))) {
+                const int dropped = m_dropped.fetchAndAddRelaxed(1) + 1;
+                // Report once per overflow, not once per lost message
+                if (!channel->overflowing) {
+                    channel->overflowing = true;
+                    LOG_WARNING("ingest", QString("Connection %1: GUI queue full, dropping messages (%2 so far)")
+                                              .arg(channel->connectionId).arg(dropped));
+                    emit overflowed(channel->connectionId, dropped);
+                }
+                return;
+            }
+            channel->overflowing = false;
+            // Only the first message after a drain posts a wakeup
+            if (m_wakePending.testAndSetOrdered(0, 1))
+                QMetaObject::invokeMethod(this, "scheduleDrain", Qt::QueuedConnection);
+        }, Qt::DirectConnection);
+
+    m_channels.insert(connectionId, channel);
+}
+
+void MessageIngestor::detach(int connectionId)
+{
+    auto channel = m_channels.take(connectionId);
+    if (!channel)
+        return;
+    disconnect(channel->connection);
+    // Hand over what arrived since the last frame, so shutdown and removal
+    // do not lose the tail (callers flush the writer after this)
+    drainChannel(*channel);
+}
+
+void MessageIngestor::scheduleDrain()
+{
+    if (!m_frameTimer.isActive())
+        m_frameTimer.start();
+}
+
+void MessageIngestor::drain()
+{
+    // Reset before popping: anything pushed from here on posts a new wakeup
+    m_wakePending.storeRelease(0);
+
+    for (const auto &channel : m_channels)
+        drainChannel(*channel);
+}
+
+void MessageIngestor::drainChannel(Channel &channel)
+{
+    const int available = static_cast<int>(channel.queue.size());
+    if (available == 0)
+        return;
+    QList<MessageRecord> batch;
+    batch.reserve(available);
+    MessageRecord msg;
+    while (batch.size() < available && channel.queue.tryPop(msg))
+        batch.append(std::move(msg));
+    emit messagesReady(channel.connectionId, batch);
+}
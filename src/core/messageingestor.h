@@ -0,0 +1,66 @@
+#ifndef MESSAGEINGESTOR_H
+#define MESSAGEINGESTOR_H
+
+#include <QObject>
+#include <QMap>
+#include <QTimer>
+#include <QAtomicInt>
+#include <memory>
+#include "models.h"
+#include "spscqueue.h"
+
+class MqttClient;
+
+/**
+ * Moves received messages from client threads to the GUI thread in
+ * per-frame batches. Each attached client pushes into its own lock-free
+ * SPSC queue directly on its thread; the GUI side is woken at most once
+ * per frame (kFrameIntervalMs) and drains every queue in one pass, so GUI
+ * wakeups scale with frame rate instead of message rate.
+ */
+class MessageIngestor : public QObject
+{
+    Q_OBJECT
+public:
+    static const int kFrameIntervalMs = 16;
+    static const int kQueueCapacity   = 65536;
+
+    explicit MessageIngestor(QObject *parent = nullptr);
+    ~MessageIngestor();
+
+    void attach(int connectionId, MqttClient *client);
+    // Stops listening and delivers whatever the client had already queued
+    void detach(int connectionId);
+
+    // Messages dropped because a queue was full (GUI stalled for a long time).
+    // They never reach the views or the database.
+    int droppedCount() const { return m_dropped.loadRelaxed(); }
+
+signals:
+    // Emitted on the GUI thread, once per connection per frame
+    void messagesReady(int connectionId, const QList<MessageRecord> &messages);
+    // Emitted on the client thread when a connection's queue starts dropping
+    void overflowed(int connectionId, int droppedTotal);
+
+private slots:
+    void scheduleDrain();
+    void drain();
+
+private:
+    struct Channel {
+        explicit Channel(int id) : connectionId(id), queue(kQueueCapacity) {}
+        int connectionId;
+        SpscQueue<MessageRecord> queue;
+        QMetaObject::Connection connection;
+        bool overflowing = false; // producer thread only
+    };
+
+    void drainChannel(Channel &channel);
+
+    QMap<int, std::shared_ptr<Channel>> m_channels;
+    QTimer     m_frameTimer;
+    QAtomicInt m_wakePending{0};
+    QAtomicInt m_dropped{0};
+};
+
+#endif // MESSAGEINGESTOR_H
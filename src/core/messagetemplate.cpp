@@ -0,0 +1,144 @@
+#include "messagetemplate.h"
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonValue>
+
+static QString jsonValueText(const QJsonValue &value)
+{
+    switch (value.type()) {
+    case QJsonValue::String:
+        return value.toString();
+    case QJsonValue::Double:
+    case QJsonValue::Bool:
+        return value.toVariant().toString();
+    case QJsonValue::Object:
+        return QString::fromUtf8(QJsonDocument(value.toObject()).toJson(QJsonDocument::Compact));
+    case QJsonValue::Array:
+        return QString::fromUtf8(QJsonDocument(value.toArray()).toJson(QJsonDocument::Compact));
+    case QJsonValue::Null:
+        return "null";
+    default:
+        return QString();
+    }
+}
+
+static QJsonValue jsonLookup(const QJsonDocument &doc, const QStringList &path)
+{
+    QJsonValue current = doc.isArray() ? QJsonValue(doc.array()) : QJsonValue(doc.object());
+    for (const QString &key : path) {
+        if (current.isObject()) {
+            current = current.toObject().value(key);
+        } else if (current.isArray()) {
+            bool ok = false;
+            const int index = key.toInt(&ok);
+            const QJsonArray array = current.toArray();
+            if (!ok || index < 0 || index >= array.size())
+                return QJsonValue(QJsonValue::Undefined);
+            current = array.at(index);
+        } else {
+            return QJsonValue(QJsonValue::Undefined);
+        }
+    }
+    return current;
+}
+
+MessageTemplate::MessageTemplate(const QString &source)
+    : m_source(source)
+{
+    int pos = 0;
+    while (pos < source.size()) {
+        const int open = source.indexOf(QLatin1String("{{"), pos);
+        const int close = open < 0 ? -1 : source.indexOf(QLatin1String("}}"), open + 2);
+        if (close < 0) {
+            appendLiteral(source.mid(pos));
+            break;
+        }
+        if (open > pos)
+            appendLiteral(source.mid(pos, open - pos));
+
+        const QString name = source.mid(open + 2, close - open - 2).trimmed();
+        Segment seg{Literal, source.mid(open, close + 2 - open), QStringList()};
+        if (name == "timestamp") {
+            seg.kind = Timestamp;
+            m_needsTime = true;
+        } else if (name == "topic") {
+            seg.kind = Topic;
+        } else if (name == "payload") {
+            seg.kind = Payload;
+        } else if (name.startsWith("payload.") && name.size() > 8) {
+            seg.kind = JsonPath;
+            seg.path = name.mid(8).split('.');
+            m_needsJson = true;
+        }
+
+        if (seg.kind == Literal) {
+            // Unknown placeholder: keep it as written
+            appendLiteral(seg.text);
+        } else {
+            m_segments.append(seg);
+            ++m_placeholders;
+        }
+        pos = close + 2;
+    }
+}
+
+void MessageTemplate::appendLiteral(const QString &text)
+{
+    m_literalLength += text.size();
+    // Merge adjacent literals so render() does one append per run of text
+    if (!m_segments.isEmpty() && m_segments.last().kind == Literal)
+        m_segments.last().text += text;
+    else
+        m_segments.append(Segment{Literal, text, QStringList()});
+}
+
+QString MessageTemplate::render(const Context &context) const
+{
+    if (m_placeholders == 0)
+        return m_source;
+
+    const QString timestamp = m_needsTime
+        ? QDateTime::currentDateTime().toString(Qt::ISODate) : QString();
+    QJsonDocument json;
+    if (m_needsJson && context.hasMessage)
+        json = QJsonDocument::fromJson(context.rawPayload.isEmpty()
+                                       ? context.payload.toUtf8() : context.rawPayload);
+
+    // Resolve JSON values first so the output can be sized exactly
+    QStringList jsonValues;
+    qsizetype length = m_literalLength;
+    for (const Segment &seg : m_segments) {
+        switch (seg.kind) {
+        case Timestamp: length += timestamp.size();       break;
+        case Topic:     length += context.topic.size();   break;
+        case Payload:
+            length += context.hasMessage ? context.payload.size() : seg.text.size();
+            break;
+        case JsonPath:
+            if (!context.hasMessage)
+                jsonValues.append(seg.text);
+            else
+                jsonValues.append(json.isNull() ? QString() : jsonValueText(jsonLookup(json, seg.path)));
+            length += jsonValues.last().size();
+            break;
+        case Literal:
+            break;
+        }
+    }
+
+    QString out;
+    out.reserve(length);
+    int jsonIndex = 0;
+    for (const Segment &seg : m_segments) {
+        switch (seg.kind) {
+        case Literal:   out += seg.text;                      break;
+        case Timestamp: out += timestamp;                     break;
+        case Topic:     out += context.topic;                 break;
+        case Payload:   out += context.hasMessage ? context.payload : seg.text; break;
+        case JsonPath:  out += jsonValues.at(jsonIndex++);    break;
+        }
+    }
+    return out;
+}
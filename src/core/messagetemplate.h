@@ -0,0 +1,58 @@
+#ifndef MESSAGETEMPLATE_H
+#define MESSAGETEMPLATE_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+/**
+ * A response/command template parsed once into literal and placeholder
+ * segments. Supported placeholders:
+ *   {{timestamp}}      current local time, ISO 8601
+ *   {{topic}}          topic of the triggering message
+ *   {{payload}}        payload of the triggering message
+ *   {{payload.a.b.0}}  value at a path inside a JSON payload (empty if absent)
+ * Anything else between braces is kept verbatim, as are the payload
+ * placeholders when there is no triggering message (a command sent by
+ * hand or a load test). render() sizes its output
+ * up front and walks the segments once; the clock is only read and the
+ * payload only parsed as JSON if the template asks for them.
+ */
+class MessageTemplate
+{
+public:
+    struct Context {
+        QString    topic;
+        QString    payload;    // text used for {{payload}}
+        QByteArray rawPayload; // parsed for {{payload.x}}; falls back to payload
+        bool       hasMessage = true; // false: keep {{payload...}} as written
+    };
+
+    MessageTemplate() = default;
+    explicit MessageTemplate(const QString &source);
+
+    const QString &source() const { return m_source; }
+    bool isLiteral() const { return m_placeholders == 0; }
+
+    QString render(const Context &context) const;
+
+private:
+    enum Kind { Literal, Timestamp, Topic, Payload, JsonPath };
+    struct Segment {
+        Kind        kind;
+        QString     text; // Literal; for placeholders, the source text
+        QStringList path; // JsonPath
+    };
+
+    void appendLiteral(const QString &text);
+
+    QString        m_source;
+    QList<Segment> m_segments;
+    int            m_literalLength = 0;
+    int            m_placeholders  = 0;
+    bool           m_needsTime     = false;
+    bool           m_needsJson     = false;
+};
+
+#endif // MESSAGETEMPLATE_H
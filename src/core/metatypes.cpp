@@ -0,0 +1,16 @@
+#include "metatypes.h"
+#include "models.h"
+#include "inboundmessage.h"
+#include "loadgenerator.h"
+#include <QMetaType>
+
+void registerCoreMetaTypes()
+{
+    qRegisterMetaType<MqttConnectionConfig>("MqttConnectionConfig");
+    qRegisterMetaType<InboundMessagePtr>("InboundMessagePtr");
+    qRegisterMetaType<PublishRequest>("PublishRequest");
+    qRegisterMetaType<QList<SubscriptionConfig>>("QList<SubscriptionConfig>");
+    qRegisterMetaType<QList<PublishRequest>>("QList<PublishRequest>");
+    qRegisterMetaType<LoadProfile>("LoadProfile");
+    qRegisterMetaType<LoadStats>("LoadStats");
+}
@@ -0,0 +1,9 @@
+#ifndef METATYPES_H
+#define METATYPES_H
+
+// Registers every core type that crosses threads through queued
+// connections or QMetaObject::invokeMethod. Call once from main thread
+// setup, before any client is created.
+void registerCoreMetaTypes();
+
+#endif // METATYPES_H
@@ -2,6 +2,7 @@
 #define MODELS_H
 
 #include <QString>
+#include <QByteArray>
 #include <QDateTime>
 #include <QMetaType>
 
@@ -73,16 +74,61 @@ struct SubscriptionConfig {
 struct MessageRecord {
     int id;
     int connectionId;
-    QString topic;
-    QString payload;
+    QString topic;      // canonical TopicRegistry string where available
+    int topicId;        // TopicRegistry id, -1 if not interned
+    QByteArray payload; // raw bytes; decode with PayloadFormat when displaying
     bool outgoing;
     bool retained;
-    QDateTime timestamp;
+    qint64 timestampMs; // milliseconds since the Unix epoch
 
     MessageRecord()
-        : id(-1), connectionId(-1), outgoing(false), retained(false) {}
+        : id(-1), connectionId(-1), topicId(-1), outgoing(false), retained(false),
+          timestampMs(0), m_cachedMs(-1) {}
+
+    // Local-time view of timestampMs, only built when a view needs it
+    QDateTime timestamp() const
+    {
+        if (m_cachedMs != timestampMs) {
+            m_dateTime = QDateTime::fromMSecsSinceEpoch(timestampMs);
+            m_cachedMs = timestampMs;
+        }
+        return m_dateTime;
+    }
+
+private:
+    mutable QDateTime m_dateTime;
+    mutable qint64    m_cachedMs;
+};
+
+// Filters for DatabaseManager::searchMessages(); every set field must match
+struct MessageSearchQuery {
+    int connectionId;    // -1 = all connections
+    QString topicFilter; // MQTT filter ('+' and '#' allowed), empty = any topic
+    qint64 fromMs;       // inclusive epoch-ms bounds, 0 = open
+    qint64 toMs;
+    QString terms;       // whitespace-separated; each must occur in the payload
+    int beforeId;        // keyset cursor: only rows with id < beforeId, 0 = newest
+    int limit;
+
+    MessageSearchQuery()
+        : connectionId(-1), fromMs(0), toMs(0), beforeId(0), limit(200) {}
+};
+
+// One outgoing message, already encoded, for MqttClient::publishBatch()
+struct PublishRequest {
+    QString topic;
+    QByteArray payload;
+    int qos;
+    bool retain;
+
+    PublishRequest()
+        : qos(0), retain(false) {}
+    PublishRequest(const QString &t, const QByteArray &p, int q, bool r)
+        : topic(t), payload(p), qos(q), retain(r) {}
 };
 
 Q_DECLARE_METATYPE(MqttConnectionConfig)
+Q_DECLARE_METATYPE(PublishRequest)
+Q_DECLARE_METATYPE(SubscriptionConfig)
 
 #endif // MODELS_H
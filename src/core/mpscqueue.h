@@ -0,0 +1,93 @@
+#ifndef MPSCQUEUE_H
+#define MPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+/**
+ * Bounded lock-free multi-producer / single-consumer queue (Vyukov's
+ * sequence-numbered ring). Any thread may call tryPush(); exactly one
+ * thread may call tryPop(). A push is one CAS on the shared tail plus a
+ * release store, and never blocks: a full queue makes it return false.
+ * Capacity is rounded up to the next power of two.
+ */
+template <typename T>
+class MpscQueue
+{
+public:
+    explicit MpscQueue(std::size_t capacity)
+    {
+        std::size_t cap = 2;
+        while (cap < capacity)
+            cap <<= 1;
+        m_cells.reset(new Cell[cap]);
+        for (std::size_t i = 0; i < cap; ++i)
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        m_mask = cap - 1;
+    }
+
+    MpscQueue(const MpscQueue &) = delete;
+    MpscQueue &operator=(const MpscQueue &) = delete;
+
+    bool tryPush(T &&value)
+    {
+        std::size_t pos = m_tail.load(std::memory_order_relaxed);
+        Cell *cell;
+        for (;;) {
+            cell = &m_cells[pos & m_mask];
+            const std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+            const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq)
+                                      - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                return false; // full
+            } else {
+                pos = m_tail.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(T &out)
+    {
+        const std::size_t pos = m_head.load(std::memory_order_relaxed);
+        Cell &cell = m_cells[pos & m_mask];
+        if (cell.sequence.load(std::memory_order_acquire) != pos + 1)
+            return false; // empty, or the producer has not finished writing
+        out = std::move(cell.data);
+        cell.data = T(); // release any heap data held by the slot
+        cell.sequence.store(pos + m_mask + 1, std::memory_order_release);
+        m_head.store(pos + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Approximate; may be called from any thread
+    std::size_t size() const
+    {
+        const std::size_t head = m_head.load(std::memory_order_acquire);
+        const std::size_t tail = m_tail.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+    std::size_t capacity() const { return m_mask + 1; }
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence{0};
+        T data;
+    };
+
+    std::unique_ptr<Cell[]> m_cells;
+    std::size_t             m_mask = 0;
+
+    alignas(64) std::atomic<std::size_t> m_head{0}; // consumer
+    alignas(64) std::atomic<std::size_t> m_tail{0}; // producers
+};
+
+#endif // MPSCQUEUE_H
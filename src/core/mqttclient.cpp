@@ -1,12 +1,17 @@
 #include "mqttclient.h"
-#include <QSslCertificate>
-#include <QSslKey>
-#include <QFile>
-#include <QStringDecoder>
+#include "logger.h"
+#include "tlsconfigcache.h"
+#include <QTimer>
+#include <QRandomGenerator>
 
 MqttClient::MqttClient(QObject *parent)
     : QObject(parent)
     , m_client(new QMqttClient(this))
+    , m_state(LinkState::Idle)
+    , m_wantConnected(false)
+    , m_attempt(0)
+    , m_reconnectTimer(new QTimer(this))
+    , m_disconnectTimer(new QTimer(this))
 {
     connect(m_client, &QMqttClient::connected,    this, &MqttClient::onConnected);
     connect(m_client, &QMqttClient::disconnected, this, &MqttClient::onDisconnected);
@@ -14,64 +19,117 @@ MqttClient::MqttClient(QObject *parent)
             QOverload<const QMqttMessage &>::of(&QMqttClient::messageReceived),
             this, &MqttClient::onMessageReceived);
     connect(m_client, &QMqttClient::errorChanged, this, &MqttClient::onErrorChanged);
+    connect(m_client, &QMqttClient::messageSent,  this, &MqttClient::messageSent);
+
+    m_reconnectTimer->setSingleShot(true);
+    connect(m_reconnectTimer, &QTimer::timeout, this, &MqttClient::startConnect);
+    m_disconnectTimer->setSingleShot(true);
+    m_disconnectTimer->setInterval(kDisconnectTimeoutMs);
+    connect(m_disconnectTimer, &QTimer::timeout, this, &MqttClient::onDisconnectTimeout);
 }
 
 MqttClient::~MqttClient()
 {
+    m_wantConnected = false;
     if (m_client->state() != QMqttClient::Disconnected)
         m_client->disconnectFromHost();
 }
 
 void MqttClient::connectToHost(const MqttConnectionConfig &config)
 {
-    m_config = config;
+    m_config        = config;
+    m_wantConnected = true;
+    m_attempt       = 0;
+    m_reconnectTimer->stop();
+    // A connect the user asked for is not an outage, even if it cuts one short
+    m_outageClock.invalidate();
 
-    if (m_client->state() != QMqttClient::Disconnected)
+    // Settings can only change while disconnected: close the old session
+    // first and continue in onDisconnected()
+    if (m_client->state() != QMqttClient::Disconnected) {
+        m_state = LinkState::Disconnecting;
+        m_disconnectTimer->start();
         m_client->disconnectFromHost();
+        return;
+    }
+    startConnect();
+}
 
-    m_client->setHostname(config.host);
-    m_client->setPort(static_cast<quint16>(config.port));
-    m_client->setClientId(config.clientId);
-    m_client->setUsername(config.username);
-    m_client->setPassword(config.password);
-    m_client->setCleanSession(config.cleanSession);
-    m_client->setKeepAlive(static_cast<quint16>(config.keepAlive));
-
-    if (config.useTLS) {
-        QSslConfiguration sslConfig = QSslConfiguration::defaultConfiguration();
-        sslConfig.setProtocol(QSsl::TlsV1_2OrLater);
-
-        if (!config.caCertPath.isEmpty()) {
-            QList<QSslCertificate> caCerts = QSslCertificate::fromPath(config.caCertPath);
-            if (!caCerts.isEmpty())
-                sslConfig.setCaCertificates(caCerts);
-        }
-        if (!config.clientCertPath.isEmpty() && !config.clientKeyPath.isEmpty()) {
-            QFile certFile(config.clientCertPath);
-            QFile keyFile(config.clientKeyPath);
-            if (certFile.open(QIODevice::ReadOnly) && keyFile.open(QIODevice::ReadOnly)) {
-                QSslCertificate cert(&certFile, QSsl::Pem);
-                // Try RSA first, then EC for broader key-type support
-                QSslKey key(&keyFile, QSsl::Rsa, QSsl::Pem);
-                if (key.isNull()) {
-                    keyFile.seek(0);
-                    key = QSslKey(&keyFile, QSsl::Ec, QSsl::Pem);
-                }
-                sslConfig.setLocalCertificate(cert);
-                sslConfig.setPrivateKey(key);
-                if (key.isNull()) {
-                    emit errorOccurred("TLS: failed to load private key (tried RSA and EC)");
-                }
-            }
+void MqttClient::startConnect()
+{
+    m_disconnectTimer->stop();
+    m_state = LinkState::Connecting;
+    LOG_INFO("mqtt", QString("Connecting to %1:%2 as '%3' (tls=%4, attempt %5)")
+                         .arg(m_config.host).arg(m_config.port).arg(m_config.clientId)
+                         .arg(m_config.useTLS ? "yes" : "no").arg(m_attempt));
+
+    m_client->setHostname(m_config.host);
+    m_client->setPort(static_cast<quint16>(m_config.port));
+    m_client->setClientId(m_config.clientId);
+    m_client->setUsername(m_config.username);
+    m_client->setPassword(m_config.password);
+    m_client->setCleanSession(m_config.cleanSession);
+    m_client->setKeepAlive(static_cast<quint16>(m_config.keepAlive));
+
+    if (m_config.useTLS) {
+        // Parsed PEM files are shared by all connections and reconnects
+        QString tlsError;
+        QSslConfiguration sslConfig = TlsConfigCache::instance().configuration(
+            m_config.caCertPath, m_config.clientCertPath, m_config.clientKeyPath, &tlsError);
+        if (!tlsError.isEmpty()) {
+            LOG_ERROR_LIMITED("mqtt", "TLS: " + tlsError);
+            emit errorOccurred("TLS: " + tlsError);
         }
+        const QByteArray ticket = TlsConfigCache::instance().sessionTicket(tlsSessionKey());
+        if (!ticket.isEmpty())
+            sslConfig.setSessionTicket(ticket);
         m_client->connectToHostEncrypted(sslConfig);
     } else {
         m_client->connectToHost();
     }
 }
 
+void MqttClient::onDisconnectTimeout()
+{
+    if (m_state != LinkState::Disconnecting)
+        return;
+    // The broker never answered the DISCONNECT: drop the socket instead
+    LOG_WARNING("mqtt", QString("No disconnect after %1 ms, closing transport")
+                            .arg(kDisconnectTimeoutMs));
+    if (QIODevice *transport = m_client->transport())
+        transport->close();
+    // Closing may already have run onDisconnected(), which moves on by itself
+    if (m_state != LinkState::Disconnecting)
+        return;
+    if (m_client->state() == QMqttClient::Disconnected) {
+        startConnect();
+    } else {
+        m_state = LinkState::Idle;
+        emit errorOccurred("Timed out closing the previous connection");
+    }
+}
+
+void MqttClient::scheduleReconnect()
+{
+    // Exponential backoff with "equal jitter": half fixed, half random, so
+    // clients dropped together do not all come back at the same instant
+    const int ceiling = qMin(kBackoffMaxMs, kBackoffBaseMs << qMin(m_attempt, 16));
+    const int delay   = ceiling / 2 + QRandomGenerator::global()->bounded(ceiling / 2 + 1);
+    ++m_attempt;
+
+    m_state = LinkState::Backoff;
+    m_reconnectTimer->start(delay);
+    LOG_INFO("mqtt", QString("Reconnect attempt %1 in %2 ms").arg(m_attempt).arg(delay));
+    emit reconnecting(m_attempt, delay);
+}
+
 void MqttClient::disconnectFromHost()
 {
+    m_wantConnected = false;
+    m_reconnectTimer->stop();
+    m_disconnectTimer->stop();
+    m_outageClock.invalidate();
+    m_state = LinkState::Idle;
     m_client->disconnectFromHost();
 }
 
@@ -81,8 +139,33 @@ void MqttClient::publish(const QString &topic, const QString &payload, int qos,
         emit errorOccurred("Not connected");
         return;
     }
-    QMqttTopicName topicName(topic);
-    m_client->publish(topicName, payload.toUtf8(), qos, retain);
+    publishRaw(topic, payload.toUtf8(), qos, retain);
+}
+
+void MqttClient::publishBatch(const QList<PublishRequest> &requests)
+{
+    if (m_client->state() != QMqttClient::Connected) {
+        emit errorOccurred("Not connected");
+        return;
+    }
+    // publishRaw() counts only the publishes the client accepted
+    int failed = 0;
+    for (const PublishRequest &r : requests) {
+        if (publishRaw(r.topic, r.payload, r.qos, r.retain) < 0)
+            ++failed;
+    }
+    if (failed > 0)
+        emit errorOccurred(QString("%1 of %2 publishes rejected").arg(failed).arg(requests.size()));
+}
+
+qint32 MqttClient::publishRaw(const QString &topic, const QByteArray &payload, int qos, bool retain)
+{
+    if (m_client->state() != QMqttClient::Connected)
+        return -1;
+    const qint32 id = m_client->publish(QMqttTopicName(topic), payload, static_cast<quint8>(qos), retain);
+    if (id >= 0)
+        m_publishedCount.fetchAndAddRelaxed(1);
+    return id;
 }
 
 void MqttClient::subscribe(const QString &topic, int qos)
@@ -95,6 +178,11 @@ void MqttClient::subscribe(const QString &topic, int qos)
     m_client->subscribe(filter, static_cast<quint8>(qos));
 }
 
+void MqttClient::setSubscriptions(const QList<SubscriptionConfig> &subscriptions)
+{
+    m_subscriptions = subscriptions;
+}
+
 void MqttClient::unsubscribe(const QString &topic)
 {
     QMqttTopicFilter filter(topic);
@@ -109,32 +197,103 @@ bool MqttClient::isConnected() const
 void MqttClient::onConnected()
 {
     m_connected.store(1);
+    m_state   = LinkState::Connected;
+    m_attempt = 0;
+
+    // Remember the session so the next handshake with this broker resumes it
+    if (m_config.useTLS) {
+        if (auto *socket = qobject_cast<QSslSocket *>(m_client->transport()))
+            TlsConfigCache::instance().storeSessionTicket(
+                tlsSessionKey(), socket->sslConfiguration().sessionTicket());
+    }
+
+    // Restore subscriptions from here rather than waiting on the GUI thread
+    for (const SubscriptionConfig &s : m_subscriptions)
+        m_client->subscribe(QMqttTopicFilter(s.topic), static_cast<quint8>(s.qos));
+
     emit connected();
+    if (m_outageClock.isValid()) {
+        const qint64 outageMs = m_outageClock.elapsed();
+        m_outageClock.invalidate();
+        m_lastReconnectMs.storeRelaxed(outageMs);
+        LOG_INFO("mqtt", QString("Reconnected to %1 after %2 ms").arg(m_config.host).arg(outageMs));
+        emit reconnected(outageMs);
+    }
 }
 
 void MqttClient::onDisconnected()
 {
     m_connected.store(0);
+    LOG_INFO("mqtt", "Disconnected from " + m_config.host);
+
+    if (m_state == LinkState::Disconnecting) {
+        // Old session closed; connect with the new settings. Part of a
+        // settings switch, so observers see no disconnect.
+        startConnect();
+        return;
+    }
+
     emit disconnected();
+    if (m_wantConnected) {
+        // Only a link that was up can have an outage; retries of a first
+        // connect that never succeeded are not reported as a reconnect
+        if (m_state == LinkState::Connected && !m_outageClock.isValid())
+            m_outageClock.start();
+        scheduleReconnect();
+    } else {
+        m_state = LinkState::Idle;
+    }
 }
 
 void MqttClient::onMessageReceived(const QMqttMessage &message)
 {
-    const QByteArray &bytes = message.payload();
-    QString text;
-    // Try to decode as UTF-8; if the payload has invalid bytes, show as HEX
-    auto decoder = QStringDecoder(QStringConverter::Utf8);
-    text = decoder(bytes);
-    if (decoder.hasError()) {
-        text = "HEX: " + QString::fromLatin1(bytes.toHex(' ')).toUpper();
-    }
-    emit messageReceived(message.topic().name(), text, message.retain());
+    m_receivedCount.fetchAndAddRelaxed(1);
+    // Forward the raw bytes; consumers decode only if they need text
+    LOG_TRACE("mqtt", QString("Received %1 bytes on %2")
+                          .arg(message.payload().size()).arg(message.topic().name()));
+    emit messageReceived(m_messagePool.create(message.topic().name(), message.payload(),
+                                              message.qos(), message.retain(), message.id()));
 }
 
 void MqttClient::onErrorChanged(QMqttClient::ClientError error)
 {
-    if (error != QMqttClient::NoError)
-        emit errorOccurred(mqttErrorString(error));
+    if (error == QMqttClient::NoError)
+        return;
+    bool fatal = false;
+    // Retrying cannot fix a rejected identity or protocol
+    switch (error) {
+    case QMqttClient::InvalidProtocolVersion:
+    case QMqttClient::IdRejected:
+    case QMqttClient::BadUsernameOrPassword:
+    case QMqttClient::NotAuthorized:
+        // QMqttClient emits disconnected() before errorChanged(), so
+        // onDisconnected() has already scheduled a retry: take it back
+        m_wantConnected = false;
+        m_reconnectTimer->stop();
+        m_outageClock.invalidate();
+        m_attempt = 0;
+        if (m_state != LinkState::Disconnecting)
+            m_state = LinkState::Idle;
+        fatal = true;
+        break;
+    case QMqttClient::TransportInvalid:
+        // A stale ticket must not keep breaking the handshake
+        if (m_config.useTLS)
+            TlsConfigCache::instance().storeSessionTicket(tlsSessionKey(), QByteArray());
+        break;
+    default:
+        break;
+    }
+    // Every failed reconnect attempt reports its error again
+    LOG_WARNING_LIMITED("mqtt", QString("%1: %2").arg(m_config.host, mqttErrorString(error)));
+    emit errorOccurred(mqttErrorString(error));
+    if (fatal)
+        emit connectAbandoned(mqttErrorString(error));
+}
+
+QString MqttClient::tlsSessionKey() const
+{
+    return QString("%1:%2|%3").arg(m_config.host).arg(m_config.port).arg(m_config.clientCertPath);
 }
 
 QString MqttClient::mqttErrorString(QMqttClient::ClientError error) const
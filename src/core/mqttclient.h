@@ -9,8 +9,21 @@
 #include <QSslSocket>
 #include <QSslConfiguration>
 #include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QList>
 #include "models.h"
+#include "inboundmessage.h"
 
+class QTimer;
+
+/**
+ * One broker connection, driven entirely from its own thread. Connecting
+ * is asynchronous: a reconnect with new settings waits for the old session's
+ * disconnected() (bounded by kDisconnectTimeoutMs) instead of blocking the
+ * thread. An unexpected disconnect is retried with exponential backoff plus
+ * jitter until disconnectFromHost() is called, and every (re)connect
+ * re-subscribes to the list given to setSubscriptions().
+ */
 class MqttClient : public QObject
 {
     Q_OBJECT
@@ -21,29 +34,72 @@ public:
     Q_INVOKABLE void connectToHost(const MqttConnectionConfig &config);
     Q_INVOKABLE void disconnectFromHost();
     Q_INVOKABLE void publish(const QString &topic, const QString &payload, int qos = 0, bool retain = false);
+    // Publishes every request in one event-loop turn; payloads are sent as-is
+    Q_INVOKABLE void publishBatch(const QList<PublishRequest> &requests);
     Q_INVOKABLE void subscribe(const QString &topic, int qos = 0);
     Q_INVOKABLE void unsubscribe(const QString &topic);
+    // Topics subscribed automatically after every (re)connect
+    Q_INVOKABLE void setSubscriptions(const QList<SubscriptionConfig> &subscriptions);
+
+    // Client thread only. Publishes pre-encoded bytes and returns the packet
+    // id (0 for QoS 0, -1 on failure) so callers can match messageSent()
+    qint32 publishRaw(const QString &topic, const QByteArray &payload, int qos, bool retain);
 
     // Thread-safe: uses atomic flag updated by onConnected/onDisconnected
     bool isConnected() const;
     MqttConnectionConfig currentConfig() const { return m_config; }
+    // Duration of the last outage (disconnect -> connected), -1 if none yet
+    qint64 lastReconnectMs() const { return m_lastReconnectMs.loadRelaxed(); }
+    // Thread-safe message totals, used for load accounting
+    quint64 receivedCount() const { return m_receivedCount.loadRelaxed(); }
+    quint64 publishedCount() const { return m_publishedCount.loadRelaxed(); }
+
+    static const int kDisconnectTimeoutMs = 3000;
+    static const int kBackoffBaseMs       = 500;
+    static const int kBackoffMaxMs        = 30000;
 
 signals:
     void connected();
     void disconnected();
-    void messageReceived(const QString &topic, const QString &payload, bool retained);
+    // One shared instance per message; connect directly to avoid copies
+    void messageReceived(const InboundMessagePtr &message);
     void errorOccurred(const QString &msg);
+    void reconnecting(int attempt, int delayMs);
+    void reconnected(qint64 outageMs);
+    // The broker rejected the client (credentials, id, protocol); no retry
+    void connectAbandoned(const QString &reason);
+    // The broker acknowledged a QoS 1/2 publish (PUBACK / PUBCOMP)
+    void messageSent(qint32 id);
 
 private slots:
     void onConnected();
     void onDisconnected();
     void onMessageReceived(const QMqttMessage &message);
     void onErrorChanged(QMqttClient::ClientError error);
+    void onDisconnectTimeout();
+    void startConnect();
 
 private:
+    enum class LinkState { Idle, Disconnecting, Connecting, Connected, Backoff };
+
+    void scheduleReconnect();
+
     QMqttClient  *m_client;
     MqttConnectionConfig m_config;
     QAtomicInt   m_connected{0}; // 1 = connected, 0 = not connected
+    InboundMessagePool m_messagePool;
+
+    LinkState     m_state;
+    bool          m_wantConnected;    // false after disconnectFromHost() or a fatal error
+    int           m_attempt;          // reconnect attempts in the current outage
+    QTimer       *m_reconnectTimer;
+    QTimer       *m_disconnectTimer;
+    QElapsedTimer m_outageClock;      // valid while reconnecting after a lost link
+    QAtomicInteger<qint64> m_lastReconnectMs{-1};
+    QAtomicInteger<quint64> m_receivedCount{0};
+    QAtomicInteger<quint64> m_publishedCount{0};
+    QList<SubscriptionConfig> m_subscriptions;
+    QString tlsSessionKey() const;
     QString mqttErrorString(QMqttClient::ClientError error) const;
 };
 
@@ -0,0 +1,17 @@
+#include "payloadformat.h"
+
+namespace PayloadFormat {
+
+bool isUtf8(const QByteArray &payload)
+{
+    return payload.isValidUtf8();
+}
+
+QString toDisplayText(const QByteArray &payload)
+{
+    if (payload.isValidUtf8())
+        return QString::fromUtf8(payload);
+    return "HEX: " + QString::fromLatin1(payload.toHex(' ')).toUpper();
+}
+
+} // namespace PayloadFormat
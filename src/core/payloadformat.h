@@ -0,0 +1,18 @@
+#ifndef PAYLOADFORMAT_H
+#define PAYLOADFORMAT_H
+
+#include <QByteArray>
+#include <QString>
+
+// Payloads travel and are stored as raw bytes; these helpers turn them into
+// text only at the point a view needs to show them.
+namespace PayloadFormat {
+
+bool isUtf8(const QByteArray &payload);
+
+// Valid UTF-8 is decoded as-is; anything else is rendered as "HEX: 0A 1B ..."
+QString toDisplayText(const QByteArray &payload);
+
+} // namespace PayloadFormat
+
+#endif // PAYLOADFORMAT_H
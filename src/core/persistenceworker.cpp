@@ -0,0 +1,259 @@
+#include "persistenceworker.h"
+#include "logger.h"
+#include <QTimer>
+#include <QThread>
+#include <QPromise>
+#include <QElapsedTimer>
+#include <QDeadlineTimer>
+#include <memory>
+
+PersistenceWorker::PersistenceWorker(QObject *parent)
+    : QObject(parent)
+    , m_queue(kQueueCapacity)
+    , m_flushTimer(nullptr)
+{
+}
+
+PersistenceWorker::~PersistenceWorker()
+{
+}
+
+// ---- Producer side ----
+
+bool PersistenceWorker::enqueue(const MessageRecord &msg)
+{
+    if (m_running.loadAcquire() == 0)
+        return false;
+
+    if (!m_queue.tryPush(msg)) {
+        // Queue full: the writer is behind, so apply back-pressure for a
+        // bounded time. If it is stuck (a large delete, a slow disk) drop
+        // instead of freezing the producer, and stop waiting until it
+        // catches up so each further record does not stall again.
+        requestFlush();
+        if (m_overflowing || !waitForSpace(msg)) {
+            // Stopped while waiting: let the caller write it directly
+            if (m_running.loadAcquire() == 0)
+                return false;
+            const int dropped = m_dropped.fetchAndAddRelaxed(1) + 1;
+            if (!m_overflowing) {
+                m_overflowing = true;
+                LOG_WARNING("storage", QString("Write queue full for %1 ms, dropping messages (%2 so far)")
+                                           .arg(kEnqueueTimeoutMs).arg(dropped));
+                emit overflowed(dropped);
+            }
+            return true;
+        }
+    }
+    if (m_overflowing) {
+        m_overflowing = false;
+        LOG_WARNING("storage", QString("Write queue drained, %1 messages dropped in total")
+                                   .arg(m_dropped.loadRelaxed()));
+    }
+    if (m_queue.size() >= static_cast<std::size_t>(kBatchSize))
+        requestFlush();
+    return true;
+}
+
+QFuture<QList<MessageRecord>> PersistenceWorker::loadMessages(int connectionId, int limit)
+{
+    auto promise = std::make_shared<QPromise<QList<MessageRecord>>>();
+    QFuture<QList<MessageRecord>> future = promise->future();
+    promise->start();
+    QMetaObject::invokeMethod(this, [this, promise, connectionId, limit]() {
+        flush();
+        promise->addResult(m_db.loadMessages(connectionId, limit));
+        promise->finish();
+    }, Qt::QueuedConnection);
+    return future;
+}
+
+QFuture<QList<MessageRecord>> PersistenceWorker::loadMessagesBefore(int connectionId, int beforeId,
+                                                                    int limit)
+{
+    auto promise = std::make_shared<QPromise<QList<MessageRecord>>>();
+    QFuture<QList<MessageRecord>> future = promise->future();
+    promise->start();
+    QMetaObject::invokeMethod(this, [this, promise, connectionId, beforeId, limit]() {
+        // No flush: rows still queued get ids above any stored one, so
+        // they can never belong to an older page
+        promise->addResult(m_db.loadMessagesBefore(connectionId, beforeId, limit));
+        promise->finish();
+    }, Qt::QueuedConnection);
+    return future;
+}
+
+QFuture<QList<MessageRecord>> PersistenceWorker::searchMessages(const MessageSearchQuery &query)
+{
+    auto promise = std::make_shared<QPromise<QList<MessageRecord>>>();
+    QFuture<QList<MessageRecord>> future = promise->future();
+    promise->start();
+    QMetaObject::invokeMethod(this, [this, promise, query]() {
+        // Only the first page needs the queued rows; later pages sit below it
+        if (query.beforeId <= 0)
+            flush();
+        if (!m_searchDb) {
+            promise->addResult(m_db.searchMessages(query));
+            promise->finish();
+            return;
+        }
+        // Rows committed by the flush above are visible to the reader's
+        // next transaction
+        DatabaseManager *searchDb = m_searchDb;
+        QMetaObject::invokeMethod(searchDb, [searchDb, promise, query]() {
+            promise->addResult(searchDb->searchMessages(query));
+            promise->finish();
+        }, Qt::QueuedConnection);
+    }, Qt::QueuedConnection);
+    return future;
+}
+
+QFuture<bool> PersistenceWorker::deleteMessages(int connectionId)
+{
+    auto promise = std::make_shared<QPromise<bool>>();
+    QFuture<bool> future = promise->future();
+    promise->start();
+    QMetaObject::invokeMethod(this, [this, promise, connectionId]() {
+        // Flush first so rows queued before the delete do not reappear
+        flush();
+        promise->addResult(m_db.deleteMessages(connectionId));
+        promise->finish();
+    }, Qt::QueuedConnection);
+    return future;
+}
+
+bool PersistenceWorker::waitForSpace(const MessageRecord &msg)
+{
+    // flush() takes the mutex before waking, so a drain between tryPush()
+    // and wait() cannot be missed
+    QDeadlineTimer deadline(kEnqueueTimeoutMs);
+    QMutexLocker locker(&m_spaceMutex);
+    while (!m_queue.tryPush(msg)) {
+        if (m_running.loadAcquire() == 0 || !m_spaceFreed.wait(&m_spaceMutex, deadline))
+            return m_queue.tryPush(msg);
+    }
+    return true;
+}
+
+void PersistenceWorker::requestFlush()
+{
+    if (m_flushRequested.testAndSetOrdered(0, 1))
+        QMetaObject::invokeMethod(this, &PersistenceWorker::flush, Qt::QueuedConnection);
+}
+
+// ---- Worker thread ----
+
+bool PersistenceWorker::open(const QString &dbPath, const QString &durabilityProfile)
+{
+    m_db.setDurabilityProfile(durabilityProfile);
+    if (!m_db.open(dbPath, "mqtt_assistant_writer"))
+        return false;
+
+    m_flushTimer = new QTimer(this);
+    m_flushTimer->setInterval(kFlushIntervalMs);
+    connect(m_flushTimer, &QTimer::timeout, this, &PersistenceWorker::flush);
+    m_flushTimer->start();
+
+    if (m_db.journalMode() == QLatin1String("wal"))
+        openSearchConnection();
+
+    m_running.storeRelease(1);
+    if (m_db.fullTextBackfillPending())
+        QMetaObject::invokeMethod(this, &PersistenceWorker::backfillFullTextIndex, Qt::QueuedConnection);
+    return true;
+}
+
+void PersistenceWorker::backfillFullTextIndex()
+{
+    if (m_running.loadAcquire() == 0)
+        return; // progress is stored; the next open() carries on
+    // Each chunk is its own queued call, so flushes and reads run in between
+    const int percent = m_db.backfillFullTextIndex(kBackfillChunkRows);
+    if (percent < 0)
+        return;
+    emit fullTextIndexProgress(percent);
+    if (percent < 100)
+        QMetaObject::invokeMethod(this, &PersistenceWorker::backfillFullTextIndex, Qt::QueuedConnection);
+}
+
+void PersistenceWorker::close()
+{
+    m_running.storeRelease(0);
+    if (m_flushTimer)
+        m_flushTimer->stop();
+    flush();
+    // Lets the search page in flight finish first
+    closeSearchConnection();
+    m_db.close();
+}
+
+void PersistenceWorker::openSearchConnection()
+{
+    m_searchThread = new QThread(this);
+    m_searchDb = new DatabaseManager();
+    m_searchDb->moveToThread(m_searchThread);
+    connect(m_searchThread, &QThread::finished, m_searchDb, &QObject::deleteLater);
+    m_searchThread->start();
+
+    bool opened = false;
+    const QString path = m_db.databasePath();
+    QMetaObject::invokeMethod(m_searchDb, [this, path, &opened]() {
+        opened = m_searchDb->openReadOnly(path, "mqtt_assistant_search");
+    }, Qt::BlockingQueuedConnection);
+    if (!opened)
+        closeSearchConnection();
+}
+
+void PersistenceWorker::closeSearchConnection()
+{
+    if (!m_searchThread)
+        return;
+    // The connection must be closed on the thread that opened it
+    QMetaObject::invokeMethod(m_searchDb, [db = m_searchDb]() { db->close(); },
+                              Qt::BlockingQueuedConnection);
+    m_searchThread->quit();
+    m_searchThread->wait();
+    delete m_searchThread;
+    m_searchThread = nullptr;
+    m_searchDb = nullptr; // deleted by the thread's finished() handler
+}
+
+void PersistenceWorker::setDurabilityProfile(const QString &profile)
+{
+    m_db.setDurabilityProfile(profile);
+}
+
+void PersistenceWorker::flush()
+{
+    m_flushRequested.storeRelease(0);
+
+    QList<MessageRecord> batch;
+    batch.reserve(kBatchSize);
+    MessageRecord msg;
+    while (m_queue.tryPop(msg)) {
+        batch.append(std::move(msg));
+        if (batch.size() >= kBatchSize) {
+            wakeProducer();
+            writeBatch(batch);
+            batch.clear();
+        }
+    }
+    if (!batch.isEmpty()) {
+        wakeProducer();
+        writeBatch(batch);
+    }
+}
+
+void PersistenceWorker::wakeProducer()
+{
+    QMutexLocker locker(&m_spaceMutex);
+    m_spaceFreed.wakeAll();
+}
+
+void PersistenceWorker::writeBatch(const QList<MessageRecord> &batch)
+{
+    QElapsedTimer timer;
+    timer.start();
+    m_db.saveMessages(batch);
+    emit batchWritten(batch.size(), timer.nsecsElapsed() / 1000, backlog());
+}
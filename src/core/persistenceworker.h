@@ -0,0 +1,96 @@
+#ifndef PERSISTENCEWORKER_H
+#define PERSISTENCEWORKER_H
+
+#include <QObject>
+#include <QFuture>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QList>
+#include "databasemanager.h"
+#include "spscqueue.h"
+#include "models.h"
+
+class QTimer;
+class QThread;
+
+/**
+ * Write-behind message store. Lives on its own QThread with a private
+ * database connection. The producer (GUI) thread pushes records into a
+ * bounded lock-free queue; the worker drains it into one transaction per
+ * batch, flushing every kFlushIntervalMs or as soon as kBatchSize rows
+ * are waiting. Reads are queued behind pending writes and returned as
+ * futures, so they always observe everything enqueued before them.
+ * Searches can scan far, so in WAL mode they run on a second, read-only
+ * connection with a thread of its own and never hold up the writer.
+ */
+class PersistenceWorker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit PersistenceWorker(QObject *parent = nullptr);
+    ~PersistenceWorker();
+
+    // ---- Producer side (single thread, usually the GUI) ----
+
+    // Returns false only if the worker is not running. When the queue is
+    // full it waits up to kEnqueueTimeoutMs for the writer to make room,
+    // then drops the record (counted in droppedCount()) and keeps dropping
+    // without waiting until the queue has room again.
+    bool enqueue(const MessageRecord &msg);
+    QFuture<QList<MessageRecord>> loadMessages(int connectionId, int limit = 100);
+    QFuture<QList<MessageRecord>> loadMessagesBefore(int connectionId, int beforeId, int limit = 100);
+    QFuture<bool> deleteMessages(int connectionId);
+    // One page of DatabaseManager::searchMessages, newest first
+    QFuture<QList<MessageRecord>> searchMessages(const MessageSearchQuery &query);
+
+    int backlog() const { return static_cast<int>(m_queue.size()); }
+    int droppedCount() const { return m_dropped.loadRelaxed(); }
+
+public slots:
+    // ---- Worker thread ----
+    bool open(const QString &dbPath, const QString &durabilityProfile);
+    void close(); // flushes everything still queued
+    void flush();
+    void setDurabilityProfile(const QString &profile);
+
+private slots:
+    void backfillFullTextIndex(); // one chunk, then requeues itself
+
+signals:
+    void batchWritten(int rows, qint64 latencyUs, int backlog);
+    // Emitted on the producer thread when records start being dropped
+    void overflowed(int droppedTotal);
+    // Indexing of history that predates the full-text index; 100 when done
+    void fullTextIndexProgress(int percent);
+
+private:
+    void requestFlush();
+    bool waitForSpace(const MessageRecord &msg);
+    void wakeProducer();
+    void writeBatch(const QList<MessageRecord> &batch);
+    void openSearchConnection();
+    void closeSearchConnection();
+
+    static const int kBatchSize       = 500;
+    static const int kFlushIntervalMs = 50;
+    static const int kQueueCapacity   = 65536;
+    static const int kEnqueueTimeoutMs = 200;
+    static const int kBackfillChunkRows = 5000;
+
+    DatabaseManager          m_db;
+    SpscQueue<MessageRecord> m_queue;
+    QTimer                  *m_flushTimer;
+    // Read-only connection living on m_searchThread; null outside WAL mode,
+    // where a long read would block commits and searches stay on this thread
+    DatabaseManager         *m_searchDb = nullptr;
+    QThread                 *m_searchThread = nullptr;
+    QAtomicInt               m_running{0};
+    QAtomicInt               m_flushRequested{0};
+    QAtomicInt               m_dropped{0};
+    bool                     m_overflowing = false; // producer thread only
+    QMutex                   m_spaceMutex;
+    QWaitCondition           m_spaceFreed;          // woken after each drain
+};
+
+#endif // PERSISTENCEWORKER_H
@@ -1,34 +1,47 @@
 #include "scriptengine.h"
 #include "mqttclient.h"
-#include <QRegularExpression>
-#include <QDateTime>
+#include "payloadformat.h"
 #include <QTimer>
+#include <QSet>
+#include <algorithm>
+
 ScriptEngine::ScriptEngine(QObject *parent)
     : QObject(parent)
     , m_client(nullptr)
+    , m_snapshot(std::make_shared<const Snapshot>())
+    , m_wheelTimer(new QTimer(this))
 {
+    m_clock.start();
+    m_wheelTimer->setTimerType(Qt::PreciseTimer);
+    m_wheelTimer->setInterval(kTickMs);
+    connect(m_wheelTimer, &QTimer::timeout, this, &ScriptEngine::onWheelTick);
 }
 
 ScriptEngine::~ScriptEngine() {}
 
 void ScriptEngine::setClient(MqttClient *client)
 {
-    if (m_client) {
-        disconnect(m_client, &MqttClient::messageReceived, this, &ScriptEngine::onMessageReceived);
+    MqttClient *previous = m_client.loadAcquire();
+    if (previous) {
+        disconnect(previous, &MqttClient::messageReceived, this, &ScriptEngine::onMessageReceived);
+    }
+    m_client.storeRelease(client);
+    if (client) {
+        // Direct when the engine shares the client's thread, queued otherwise
+        connect(client, &MqttClient::messageReceived, this, &ScriptEngine::onMessageReceived);
     }
-    m_client = client;
-    if (m_client) {
-        connect(m_client, &MqttClient::messageReceived, this, &ScriptEngine::onMessageReceived);
-    }}
+}
 
 void ScriptEngine::setScripts(const QList<ScriptConfig> &scripts)
 {
     m_scripts = scripts;
+    publishSnapshot();
 }
 
 void ScriptEngine::addScript(const ScriptConfig &script)
 {
     m_scripts.append(script);
+    publishSnapshot();
 }
 
 void ScriptEngine::updateScript(const ScriptConfig &script)
@@ -36,10 +49,12 @@ void ScriptEngine::updateScript(const ScriptConfig &script)
     for (int i = 0; i < m_scripts.size(); ++i) {
         if (m_scripts[i].id == script.id) {
             m_scripts[i] = script;
+            publishSnapshot();
             return;
         }
     }
     m_scripts.append(script);
+    publishSnapshot();
 }
 
 void ScriptEngine::removeScript(int scriptId)
@@ -47,6 +62,7 @@ void ScriptEngine::removeScript(int scriptId)
     for (int i = 0; i < m_scripts.size(); ++i) {
         if (m_scripts[i].id == scriptId) {
             m_scripts.removeAt(i);
+            publishSnapshot();
             return;
         }
     }
@@ -55,100 +71,147 @@ void ScriptEngine::removeScript(int scriptId)
 void ScriptEngine::clearScripts()
 {
     m_scripts.clear();
+    publishSnapshot();
+}
+
+void ScriptEngine::publishSnapshot()
+{
+    const std::shared_ptr<const Snapshot> previous = std::atomic_load(&m_snapshot);
+    auto snapshot = std::make_shared<Snapshot>();
+    snapshot->scripts.reserve(m_scripts.size());
+    for (int i = 0; i < m_scripts.size(); ++i) {
+        const ScriptConfig &script = m_scripts[i];
+        if (!script.enabled) {
+            snapshot->scripts.append(CompiledScript{script, TriggerCondition(),
+                                                    MessageTemplate(), MessageTemplate()});
+            continue;
+        }
+        snapshot->scripts.append(CompiledScript{
+            script,
+            TriggerCondition::compile(script.triggerCondition, script.triggerValue),
+            MessageTemplate(script.responseTopic),
+            MessageTemplate(script.responsePayload)});
+        if (script.triggerTopic.isEmpty())
+            snapshot->anyTopicScripts.append(i);
+        else
+            snapshot->topicIndex.insert(script.triggerTopic, i);
+    }
+
+    // Drop delayed responses of scripts that were disabled or removed
+    QSet<int> stillEnabled;
+    for (const CompiledScript &script : snapshot->scripts) {
+        if (script.config.enabled)
+            stillEnabled.insert(script.config.id);
+    }
+    QList<int> dropped;
+    for (const CompiledScript &script : previous->scripts) {
+        if (script.config.enabled && !stillEnabled.contains(script.config.id))
+            dropped.append(script.config.id);
+    }
+
+    // Publish before cancelling: a message evaluated after the cancel must
+    // already see the new snapshot, or it could schedule a response for a
+    // script that is gone
+    std::atomic_store(&m_snapshot, std::shared_ptr<const Snapshot>(std::move(snapshot)));
+    for (int id : dropped)
+        QMetaObject::invokeMethod(this, "cancelPendingResponses", Qt::QueuedConnection,
+                                  Q_ARG(int, id));
 }
 
-void ScriptEngine::onMessageReceived(const QString &topic, const QString &payload, bool retained)
+void ScriptEngine::onMessageReceived(const InboundMessagePtr &message)
 {
     // Do not trigger scripts for retained messages (broker resent state on reconnect)
-    if (retained)
+    if (message->retained)
         return;
 
-    if (!m_client || !m_client->isConnected())
+    MqttClient *client = m_client.loadAcquire();
+    if (!client || !client->isConnected())
         return;
 
-    for (const ScriptConfig &script : m_scripts) {
-        if (!script.enabled)
+    // Hold one snapshot for the whole message, even if scripts change meanwhile
+    const std::shared_ptr<const Snapshot> snapshot = std::atomic_load(&m_snapshot);
+
+    // Candidate scripts whose topic filter matches, in script order
+    QList<int> candidates = snapshot->topicIndex.match(message->topic);
+    if (!snapshot->anyTopicScripts.isEmpty()) {
+        candidates.append(snapshot->anyTopicScripts);
+        std::sort(candidates.begin(), candidates.end());
+    }
+    if (candidates.isEmpty())
+        return;
+
+    // Conditions and templates see the same text as the views (non-UTF-8
+    // payloads as "HEX: ..."); raw bytes stay available to byte-level paths
+    const MessageTemplate::Context context{message->topic,
+                                           PayloadFormat::toDisplayText(message->payload),
+                                           message->payload};
+
+    // Immediate responses of all matching scripts go out together
+    QList<PublishRequest> immediate;
+    for (int index : candidates) {
+        const CompiledScript &script = snapshot->scripts[index];
+        if (!script.condition.matches(context.payload))
             continue;
 
-        // Topic filter: empty means any topic
-        if (!script.triggerTopic.isEmpty()) {
-            // Simple wildcard matching: # and +
-            QRegularExpression topicRx(
-                "^" + QRegularExpression::escape(script.triggerTopic)
-                          .replace("\\#", ".*")
-                          .replace("\\+", "[^/]+") + "$");
-            if (!topicRx.match(topic).hasMatch())
-                continue;
+        PublishRequest response = renderResponse(script, context);
+        if (script.config.delayMs <= 0) {
+            immediate.append(std::move(response));
+            continue;
         }
 
-        if (matchesCondition(script, topic, payload)) {
-            triggerScript(script, topic, payload);
-        }
+        // Round up so a response never goes out before its delay has passed
+        const quint64 now = currentTick();
+        if (m_wheel.isEmpty())
+            m_wheel.reset(now);
+        const quint64 expiry = now + (script.config.delayMs + kTickMs - 1) / kTickMs;
+        m_wheel.schedule(expiry, script.config.id, std::move(response));
+        m_pendingCount.storeRelaxed(m_wheel.size());
+        if (!m_wheelTimer->isActive())
+            m_wheelTimer->start();
     }
+    if (!immediate.isEmpty())
+        publishResponses(immediate);
 }
 
-bool ScriptEngine::matchesCondition(const ScriptConfig &script,
-                                    const QString &topic,
-                                    const QString &payload) const
+PublishRequest ScriptEngine::renderResponse(const CompiledScript &script,
+                                            const MessageTemplate::Context &context) const
 {
-    Q_UNUSED(topic)
-    const QString &cond  = script.triggerCondition;
-    const QString &value = script.triggerValue;
-
-    if (cond == "any")
-        return true;
-    if (cond == "contains")
-        return payload.contains(value);
-    if (cond == "equals")
-        return payload == value;
-    if (cond == "startsWith")
-        return payload.startsWith(value);
-    if (cond == "endsWith")
-        return payload.endsWith(value);
-    if (cond == "regex") {
-        QRegularExpression rx(value);
-        return rx.match(payload).hasMatch();
-    }
-    return false;
+    return PublishRequest(script.responseTopic.render(context),
+                          script.responsePayload.render(context).toUtf8(),
+                          script.config.responseQos,
+                          script.config.responseRetain);
 }
 
-QString ScriptEngine::substituteVariables(const QString &tmpl,
-                                          const QString &topic,
-                                          const QString &payload) const
+void ScriptEngine::onWheelTick()
 {
-    QString result = tmpl;
-    result.replace("{{timestamp}}", QDateTime::currentDateTime().toString(Qt::ISODate));
-    result.replace("{{topic}}",     topic);
-    result.replace("{{payload}}",   payload);
-    return result;
+    std::vector<TimingWheel<PublishRequest>::Entry> due;
+    m_wheel.advance(currentTick(), due);
+    m_pendingCount.storeRelaxed(m_wheel.size());
+    if (m_wheel.isEmpty())
+        m_wheelTimer->stop();
+
+    MqttClient *client = m_client.loadAcquire();
+    if (due.empty() || !client || !client->isConnected())
+        return;
+    QList<PublishRequest> responses;
+    responses.reserve(static_cast<qsizetype>(due.size()));
+    for (auto &entry : due)
+        responses.append(std::move(entry.value));
+    publishResponses(responses);
 }
 
-void ScriptEngine::triggerScript(const ScriptConfig &script,
-                                 const QString &topic,
-                                 const QString &payload)
+void ScriptEngine::cancelPendingResponses(int scriptId)
 {
-    QString responseTopic   = substituteVariables(script.responseTopic, topic, payload);
-    QString responsePayload = substituteVariables(script.responsePayload, topic, payload);
-    int qos     = script.responseQos;
-    bool retain = script.responseRetain;
-
-    if (script.delayMs <= 0) {
-        // Use invokeMethod so the call is safe even if client lives on another thread
-        QMetaObject::invokeMethod(m_client, "publish", Qt::QueuedConnection,
-                                  Q_ARG(QString, responseTopic),
-                                  Q_ARG(QString, responsePayload),
-                                  Q_ARG(int, qos),
-                                  Q_ARG(bool, retain));
-    } else {
-        // Capture by value for deferred execution
-        QTimer::singleShot(script.delayMs, this, [this, responseTopic, responsePayload, qos, retain]() {
-            if (m_client && m_client->isConnected()) {
-                QMetaObject::invokeMethod(m_client, "publish", Qt::QueuedConnection,
-                                          Q_ARG(QString, responseTopic),
-                                          Q_ARG(QString, responsePayload),
-                                          Q_ARG(int, qos),
-                                          Q_ARG(bool, retain));
-            }
-        });
-    }
+    if (m_wheel.cancel(scriptId) == 0)
+        return;
+    m_pendingCount.storeRelaxed(m_wheel.size());
+    if (m_wheel.isEmpty())
+        m_wheelTimer->stop();
+}
+
+void ScriptEngine::publishResponses(const QList<PublishRequest> &responses)
+{
+    // Direct call when the engine shares the client's thread, queued otherwise
+    QMetaObject::invokeMethod(m_client.loadAcquire(), "publishBatch", Qt::AutoConnection,
+                              Q_ARG(QList<PublishRequest>, responses));
 }
@@ -5,10 +5,27 @@
 #include <QList>
 #include <QMap>
 #include <QTimer>
+#include <QAtomicPointer>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <memory>
 #include "models.h"
+#include "topicfiltertrie.h"
+#include "triggercondition.h"
+#include "messagetemplate.h"
+#include "timingwheel.h"
 
 class MqttClient;
 
+/**
+ * Evaluates auto-response scripts against one client's received messages.
+ * Intended to live on that client's thread, so each connection evaluates
+ * its rules in parallel and responses are not delayed by GUI work.
+ * The configuration methods are called from the owning (GUI) thread: each
+ * change compiles a new immutable Snapshot and publishes it atomically, and
+ * onMessageReceived() always evaluates against one consistent snapshot
+ * without taking a lock.
+ */
 class ScriptEngine : public QObject
 {
     Q_OBJECT
@@ -17,6 +34,7 @@ public:
     ~ScriptEngine();
 
     void setClient(MqttClient *client);
+    MqttClient *client() const { return m_client.loadAcquire(); }
     void setScripts(const QList<ScriptConfig> &scripts);
     void addScript(const ScriptConfig &script);
     void updateScript(const ScriptConfig &script);
@@ -24,16 +42,50 @@ public:
     void clearScripts();
     QList<ScriptConfig> scripts() const { return m_scripts; }
 
+    // Delayed responses waiting to be published; safe to read from any thread
+    int pendingResponses() const { return m_pendingCount.loadRelaxed(); }
+
 public slots:
-    void onMessageReceived(const QString &topic, const QString &payload, bool retained);
+    void onMessageReceived(const InboundMessagePtr &message);
+    void cancelPendingResponses(int scriptId);
+
+private slots:
+    void onWheelTick();
 
 private:
-    bool matchesCondition(const ScriptConfig &script, const QString &topic, const QString &payload) const;
-    QString substituteVariables(const QString &tmpl, const QString &topic, const QString &payload) const;
-    void triggerScript(const ScriptConfig &script, const QString &topic, const QString &payload);
+    // Everything a script needs at match time, built once per script change
+    struct CompiledScript {
+        ScriptConfig     config;
+        TriggerCondition condition;
+        MessageTemplate  responseTopic;
+        MessageTemplate  responsePayload;
+    };
+
+    // Immutable once published; indices refer to scripts
+    struct Snapshot {
+        QList<CompiledScript> scripts;
+        TopicFilterTrie       topicIndex;      // enabled scripts by trigger topic
+        QList<int>            anyTopicScripts; // enabled, empty trigger topic
+    };
+
+    static const int kTickMs = 10; // delayed-response resolution
+
+    void publishSnapshot();
+    PublishRequest renderResponse(const CompiledScript &script,
+                                  const MessageTemplate::Context &context) const;
+    void publishResponses(const QList<PublishRequest> &responses);
+    quint64 currentTick() const { return static_cast<quint64>(m_clock.elapsed()) / kTickMs; }
+
+    QAtomicPointer<MqttClient> m_client;
+    QList<ScriptConfig> m_scripts; // owner thread only
+
+    std::shared_ptr<const Snapshot> m_snapshot; // accessed via std::atomic_load/store
 
-    MqttClient *m_client;
-    QList<ScriptConfig> m_scripts;
+    // Delayed responses, keyed by script id; engine thread only
+    TimingWheel<PublishRequest> m_wheel;
+    QTimer       *m_wheelTimer; // runs only while m_wheel is not empty
+    QElapsedTimer m_clock;
+    QAtomicInt    m_pendingCount{0};
 };
 
 #endif // SCRIPTENGINE_H
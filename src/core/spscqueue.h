@@ -0,0 +1,82 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/**
+ * Bounded lock-free single-producer / single-consumer queue.
+ * Exactly one thread may call tryPush() and exactly one (other) thread may
+ * call tryPop(); size() may be called from either side and is approximate.
+ * Capacity is rounded up to the next power of two.
+ */
+template <typename T>
+class SpscQueue
+{
+public:
+    explicit SpscQueue(std::size_t capacity)
+    {
+        std::size_t cap = 2;
+        while (cap < capacity)
+            cap <<= 1;
+        m_buffer.resize(cap);
+        m_mask = cap - 1;
+    }
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    bool tryPush(const T &value)
+    {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) > m_mask)
+            return false; // full
+        m_buffer[tail & m_mask] = value;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPush(T &&value)
+    {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) > m_mask)
+            return false; // full
+        m_buffer[tail & m_mask] = std::move(value);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(T &out)
+    {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire))
+            return false; // empty
+        T &slot = m_buffer[head & m_mask];
+        out = std::move(slot);
+        slot = T(); // release any heap data held by the slot
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    std::size_t size() const
+    {
+        // Read head first so the difference can never underflow
+        const std::size_t head = m_head.load(std::memory_order_acquire);
+        return m_tail.load(std::memory_order_acquire) - head;
+    }
+
+    bool isEmpty() const { return size() == 0; }
+    std::size_t capacity() const { return m_mask + 1; }
+
+private:
+    std::vector<T> m_buffer;
+    std::size_t    m_mask = 0;
+
+    // Producer and consumer indices live on separate cache lines
+    alignas(64) std::atomic<std::size_t> m_head{0}; // consumer
+    alignas(64) std::atomic<std::size_t> m_tail{0}; // producer
+};
+
+#endif // SPSCQUEUE_H
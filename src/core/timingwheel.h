@@ -0,0 +1,141 @@
+#ifndef TIMINGWHEEL_H
+#define TIMINGWHEEL_H
+
+#include <QtGlobal>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+/**
+ * Hierarchical timing wheel: kLevels wheels of kSlots slots each, where a
+ * slot on level n spans kSlots^n ticks. schedule() is O(1); advance()
+ * costs O(1) per elapsed tick plus the entries it fires or cascades down a
+ * level, and hands back everything due in one batch. Every entry carries an
+ * integer key so all entries for an owner can be cancelled together.
+ * Delays longer than the wheel's span are clamped to the span.
+ * Not thread-safe.
+ */
+template <typename T>
+class TimingWheel
+{
+public:
+    static const int kSlotBits = 6;
+    static const int kSlots    = 1 << kSlotBits;
+    static const int kLevels   = 4; // 2^24 ticks
+
+    struct Entry {
+        quint64 expiry;
+        int     key;
+        T       value;
+    };
+
+    TimingWheel()
+        : m_levels(kLevels, std::vector<std::vector<Entry>>(kSlots))
+    {
+    }
+
+    int size() const { return m_size; }
+    bool isEmpty() const { return m_size == 0; }
+    quint64 currentTick() const { return m_current; }
+
+    // Moves the wheel's clock; only valid while the wheel is empty
+    void reset(quint64 tick)
+    {
+        Q_ASSERT(m_size == 0);
+        m_current = tick;
+    }
+
+    // Entries already in the past fire on the next advance()
+    void schedule(quint64 expiryTick, int key, T value)
+    {
+        place(Entry{expiryTick, key, std::move(value)});
+        ++m_size;
+    }
+
+    // Appends every entry due at or before nowTick to out, in expiry order
+    void advance(quint64 nowTick, std::vector<Entry> &out)
+    {
+        while (m_current <= nowTick && m_size > 0) {
+            // Pull the next span of each higher level down when its digit rolls over
+            for (int level = 1; level < kLevels; ++level) {
+                if ((m_current & spanMask(level)) != 0)
+                    break;
+                cascade(level, slotIndex(m_current, level));
+            }
+
+            std::vector<Entry> &slot = m_levels[0][slotIndex(m_current, 0)];
+            for (Entry &e : slot)
+                out.push_back(std::move(e));
+            m_size -= static_cast<int>(slot.size());
+            slot.clear();
+            ++m_current;
+        }
+        // Nothing left to step through: jump straight to the present
+        if (m_size == 0 && m_current <= nowTick)
+            m_current = nowTick + 1;
+    }
+
+    // Removes all entries with the given key; returns how many were removed
+    int cancel(int key)
+    {
+        int removed = 0;
+        for (auto &level : m_levels) {
+            for (auto &slot : level) {
+                auto it = std::remove_if(slot.begin(), slot.end(),
+                                         [key](const Entry &e) { return e.key == key; });
+                removed += static_cast<int>(slot.end() - it);
+                slot.erase(it, slot.end());
+            }
+        }
+        m_size -= removed;
+        return removed;
+    }
+
+    void clear()
+    {
+        for (auto &level : m_levels)
+            for (auto &slot : level)
+                slot.clear();
+        m_size = 0;
+    }
+
+private:
+    static quint64 spanMask(int level)
+    {
+        return (quint64(1) << (kSlotBits * level)) - 1;
+    }
+
+    static int slotIndex(quint64 tick, int level)
+    {
+        return static_cast<int>((tick >> (kSlotBits * level)) & (kSlots - 1));
+    }
+
+    void place(Entry &&e)
+    {
+        static const quint64 kMaxDelta = (quint64(1) << (kSlotBits * kLevels)) - 1;
+        if (e.expiry < m_current)
+            e.expiry = m_current;
+        if (e.expiry - m_current > kMaxDelta)
+            e.expiry = m_current + kMaxDelta;
+
+        const quint64 delta = e.expiry - m_current;
+        int level = 0;
+        while (level < kLevels - 1 && delta > spanMask(level + 1))
+            ++level;
+        m_levels[level][slotIndex(e.expiry, level)].push_back(std::move(e));
+    }
+
+    void cascade(int level, int slot)
+    {
+        std::vector<Entry> entries;
+        entries.swap(m_levels[level][slot]);
+        for (Entry &e : entries)
+            place(std::move(e));
+    }
+
+    std::vector<std::vector<std::vector<Entry>>> m_levels;
+    quint64 m_current = 0; // next tick to process
+    int     m_size    = 0;
+};
+
+#endif // TIMINGWHEEL_H
@@ -0,0 +1,118 @@
+#include "tlsconfigcache.h"
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QSslCertificate>
+#include <QSslKey>
+
+TlsConfigCache &TlsConfigCache::instance()
+{
+    static TlsConfigCache cache;
+    return cache;
+}
+
+QString TlsConfigCache::fileStamp(const QString &path)
+{
+    if (path.isEmpty())
+        return QString();
+    const QFileInfo info(path);
+    return QString("%1@%2:%3").arg(info.absoluteFilePath())
+                              .arg(info.lastModified().toMSecsSinceEpoch())
+                              .arg(info.size());
+}
+
+QSslConfiguration TlsConfigCache::configuration(const QString &caCertPath,
+                                                const QString &clientCertPath,
+                                                const QString &clientKeyPath,
+                                                QString *error)
+{
+    const QString key = fileStamp(caCertPath) + '|' + fileStamp(clientCertPath)
+                      + '|' + fileStamp(clientKeyPath);
+
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_configs.constFind(key);
+        if (it != m_configs.constEnd()) {
+            if (error)
+                *error = it->error;
+            return it->config;
+        }
+    }
+
+    // Parse outside the lock; two threads racing on a new key both load and
+    // the second insert wins, which is harmless
+    const Entry entry = load(caCertPath, clientCertPath, clientKeyPath);
+
+    QMutexLocker locker(&m_mutex);
+    // Stale stamps of edited files are never asked for again
+    if (m_configs.size() >= kMaxEntries)
+        m_configs.clear();
+    m_configs.insert(key, entry);
+    if (error)
+        *error = entry.error;
+    return entry.config;
+}
+
+TlsConfigCache::Entry TlsConfigCache::load(const QString &caCertPath,
+                                           const QString &clientCertPath,
+                                           const QString &clientKeyPath)
+{
+    Entry entry;
+    // The default configuration resolves the system CA store once per
+    // process; copies share it implicitly
+    entry.config = QSslConfiguration::defaultConfiguration();
+    entry.config.setProtocol(QSsl::TlsV1_2OrLater);
+    // Keep session tickets so the next connect can resume
+    entry.config.setSslOption(QSsl::SslOptionDisableSessionPersistence, false);
+
+    if (!caCertPath.isEmpty()) {
+        const QList<QSslCertificate> caCerts = QSslCertificate::fromPath(caCertPath);
+        if (caCerts.isEmpty())
+            entry.error = "failed to load CA certificate " + caCertPath;
+        else
+            entry.config.setCaCertificates(caCerts);
+    }
+
+    if (!clientCertPath.isEmpty() && !clientKeyPath.isEmpty()) {
+        QFile certFile(clientCertPath);
+        QFile keyFile(clientKeyPath);
+        if (!certFile.open(QIODevice::ReadOnly) || !keyFile.open(QIODevice::ReadOnly)) {
+            entry.error = "failed to open client certificate or key";
+            return entry;
+        }
+        const QSslCertificate cert(&certFile, QSsl::Pem);
+        const QByteArray keyPem = keyFile.readAll();
+        // Try RSA first, then EC for broader key-type support
+        QSslKey key(keyPem, QSsl::Rsa, QSsl::Pem);
+        if (key.isNull())
+            key = QSslKey(keyPem, QSsl::Ec, QSsl::Pem);
+
+        entry.config.setLocalCertificate(cert);
+        entry.config.setPrivateKey(key);
+        if (key.isNull())
+            entry.error = "failed to load private key (tried RSA and EC)";
+    }
+    return entry;
+}
+
+QByteArray TlsConfigCache::sessionTicket(const QString &sessionKey) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_sessions.value(sessionKey);
+}
+
+void TlsConfigCache::storeSessionTicket(const QString &sessionKey, const QByteArray &ticket)
+{
+    QMutexLocker locker(&m_mutex);
+    if (ticket.isEmpty())
+        m_sessions.remove(sessionKey);
+    else
+        m_sessions.insert(sessionKey, ticket);
+}
+
+void TlsConfigCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_configs.clear();
+    m_sessions.clear();
+}
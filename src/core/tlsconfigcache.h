@@ -0,0 +1,57 @@
+#ifndef TLSCONFIGCACHE_H
+#define TLSCONFIGCACHE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QSslConfiguration>
+#include <QString>
+
+/**
+ * Process-wide cache of ready-to-use TLS configurations. Entries are keyed
+ * by the CA / client certificate / key paths together with each file's
+ * size and modification time, so PEM files are parsed once and re-read
+ * only after they change on disk. The cache also keeps the last session
+ * ticket per broker so reconnects can resume the TLS session instead of
+ * running a full handshake. Thread-safe.
+ */
+class TlsConfigCache
+{
+public:
+    static TlsConfigCache &instance();
+
+    // Returns the configuration for the given files (any may be empty).
+    // Load problems are reported through *error; the returned configuration
+    // is still usable but lacks the part that failed.
+    QSslConfiguration configuration(const QString &caCertPath,
+                                    const QString &clientCertPath,
+                                    const QString &clientKeyPath,
+                                    QString *error = nullptr);
+
+    // sessionKey identifies broker and client identity, e.g. "host:port|cert"
+    QByteArray sessionTicket(const QString &sessionKey) const;
+    void storeSessionTicket(const QString &sessionKey, const QByteArray &ticket);
+
+    void clear();
+
+private:
+    struct Entry {
+        QSslConfiguration config;
+        QString           error;
+    };
+
+    TlsConfigCache() = default;
+    Q_DISABLE_COPY(TlsConfigCache)
+
+    static QString fileStamp(const QString &path);
+    static Entry load(const QString &caCertPath, const QString &clientCertPath,
+                      const QString &clientKeyPath);
+
+    static const int kMaxEntries = 32;
+
+    mutable QMutex             m_mutex;
+    QHash<QString, Entry>      m_configs;
+    QHash<QString, QByteArray> m_sessions;
+};
+
+#endif // TLSCONFIGCACHE_H
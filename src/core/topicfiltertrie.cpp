@@ -0,0 +1,106 @@
+#include "topicfiltertrie.h"
+#include <QDebug>
+#include <algorithm>
+
+TopicFilterTrie::TopicFilterTrie()
+{
+    clear();
+}
+
+bool TopicFilterTrie::isValidFilter(const QString &filter)
+{
+    if (filter.isEmpty())
+        return false;
+    const QStringList levels = filter.split('/');
+    for (int i = 0; i < levels.size(); ++i) {
+        const QString &level = levels[i];
+        if (level == "#") {
+            if (i != levels.size() - 1)
+                return false; // '#' must be the last level
+        } else if (level != "+" && (level.contains('#') || level.contains('+'))) {
+            return false;     // wildcards must occupy a whole level
+        }
+    }
+    return true;
+}
+
+bool TopicFilterTrie::insert(const QString &filter, int value)
+{
+    if (!isValidFilter(filter)) {
+        qWarning() << "Invalid topic filter ignored:" << filter;
+        return false;
+    }
+
+    int node = 0;
+    const QStringList levels = filter.split('/');
+    for (const QString &level : levels) {
+        if (level == "#") {
+            m_nodes[node].multiLevel.append(value);
+            ++m_size;
+            return true;
+        }
+        node = childFor(node, level);
+    }
+    m_nodes[node].values.append(value);
+    ++m_size;
+    return true;
+}
+
+void TopicFilterTrie::clear()
+{
+    m_nodes.clear();
+    m_nodes.emplace_back();
+    m_size = 0;
+}
+
+int TopicFilterTrie::childFor(int node, const QString &level)
+{
+    // Indices rather than pointers: emplace_back may reallocate m_nodes
+    const int existing = level == "+" ? m_nodes[node].singleLevel
+                                      : m_nodes[node].children.value(level, -1);
+    if (existing >= 0)
+        return existing;
+
+    const int child = static_cast<int>(m_nodes.size());
+    m_nodes.emplace_back();
+    if (level == "+")
+        m_nodes[node].singleLevel = child;
+    else
+        m_nodes[node].children.insert(level, child);
+    return child;
+}
+
+QList<int> TopicFilterTrie::match(const QString &topic) const
+{
+    QList<int> out;
+    if (topic.isEmpty() || m_size == 0)
+        return out;
+
+    const QStringList levels = topic.split('/');
+    // Wildcards in the first level never match topics starting with '$'
+    collect(0, levels, 0, topic.startsWith('$'), out);
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+void TopicFilterTrie::collect(int node, const QStringList &levels, int depth,
+                              bool systemTopic, QList<int> &out) const
+{
+    const Node &n = m_nodes[node];
+    const bool wildcardsAllowed = !(systemTopic && depth == 0);
+
+    // "a/#" also matches "a" itself, so take '#' before checking the end
+    if (wildcardsAllowed)
+        out.append(n.multiLevel);
+
+    if (depth == levels.size()) {
+        out.append(n.values);
+        return;
+    }
+
+    const int literal = n.children.value(levels[depth], -1);
+    if (literal >= 0)
+        collect(literal, levels, depth + 1, systemTopic, out);
+    if (wildcardsAllowed && n.singleLevel >= 0)
+        collect(n.singleLevel, levels, depth + 1, systemTopic, out);
+}
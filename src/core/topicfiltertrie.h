@@ -0,0 +1,48 @@
+#ifndef TOPICFILTERTRIE_H
+#define TOPICFILTERTRIE_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <vector>
+
+/**
+ * MQTT topic-filter index. Filters are inserted once with an integer value
+ * (e.g. a script index); match() then walks the trie level by level and
+ * returns every value whose filter matches the topic, following the MQTT
+ * rules for '+', '#' and '$'-prefixed topics. Cost is proportional to the
+ * number of topic levels, not the number of filters.
+ */
+class TopicFilterTrie
+{
+public:
+    TopicFilterTrie();
+
+    // Returns false (and ignores the filter) if it is not a valid MQTT filter
+    bool insert(const QString &filter, int value);
+    void clear();
+    bool isEmpty() const { return m_size == 0; }
+
+    // Matching values in ascending order
+    QList<int> match(const QString &topic) const;
+
+    static bool isValidFilter(const QString &filter);
+
+private:
+    struct Node {
+        QHash<QString, int> children;  // literal level -> node index
+        int        singleLevel = -1;   // '+' child
+        QList<int> values;             // filters ending at this node
+        QList<int> multiLevel;         // filters ending in '#' below this node
+    };
+
+    int childFor(int node, const QString &level);
+    void collect(int node, const QStringList &levels, int depth, bool systemTopic,
+                 QList<int> &out) const;
+
+    std::vector<Node> m_nodes; // m_nodes[0] is the root
+    int m_size = 0;
+};
+
+#endif // TOPICFILTERTRIE_H
@@ -0,0 +1,62 @@
+#include "topicregistry.h"
+#include "logger.h"
+
+TopicRegistry &TopicRegistry::instance()
+{
+    static TopicRegistry registry;
+    return registry;
+}
+
+QString TopicRegistry::intern(const QString &topic, int *id)
+{
+    {
+        QReadLocker locker(&m_lock);
+        const int existing = m_ids.value(topic, -1);
+        if (existing >= 0) {
+            if (id)
+                *id = existing;
+            return m_topics.at(existing);
+        }
+    }
+
+    QWriteLocker locker(&m_lock);
+    // Another thread may have added it between the two locks
+    int newId = m_ids.value(topic, -1);
+    if (newId < 0) {
+        if (m_topics.size() >= kMaxTopics) {
+            if (!m_full) {
+                m_full = true;
+                LOG_WARNING("topics", QString("Topic table full (%1 topics), new topics are no longer interned")
+                                          .arg(kMaxTopics));
+            }
+            if (id)
+                *id = -1;
+            return topic;
+        }
+        newId = m_topics.size();
+        m_topics.append(topic);
+        m_ids.insert(topic, newId);
+    }
+    if (id)
+        *id = newId;
+    return m_topics.at(newId);
+}
+
+int TopicRegistry::idFor(const QString &topic)
+{
+    int id = -1;
+    intern(topic, &id);
+    return id;
+}
+
+QString TopicRegistry::topic(int id) const
+{
+    QReadLocker locker(&m_lock);
+    return id >= 0 && id < m_topics.size() ? m_topics.at(id) : QString();
+}
+
+int TopicRegistry::size() const
+{
+    QReadLocker locker(&m_lock);
+    return m_topics.size();
+}
@@ -0,0 +1,44 @@
+#ifndef TOPICREGISTRY_H
+#define TOPICREGISTRY_H
+
+#include <QHash>
+#include <QList>
+#include <QReadWriteLock>
+#include <QString>
+
+/**
+ * Process-wide topic intern table. Every distinct topic gets a small
+ * integer id and one canonical QString; records that carry the canonical
+ * string share its data instead of holding their own copy. Ids are only
+ * meaningful within this process (the database keeps its own topic ids).
+ * Thread-safe; lookups of known topics take only a read lock.
+ *
+ * Entries are never evicted, so ids stay valid for the life of the process.
+ * Instead the table stops growing at kMaxTopics: later new topics are
+ * returned as they are, un-interned, with id -1.
+ */
+class TopicRegistry
+{
+public:
+    static TopicRegistry &instance();
+
+    // Returns the canonical string for topic and stores its id in *id, or
+    // returns topic itself and stores -1 once the table is full
+    QString intern(const QString &topic, int *id = nullptr);
+    int idFor(const QString &topic);
+    QString topic(int id) const;
+    int size() const;
+
+    static const int kMaxTopics = 65536;
+
+private:
+    TopicRegistry() = default;
+    Q_DISABLE_COPY(TopicRegistry)
+
+    mutable QReadWriteLock  m_lock;
+    QHash<QString, int>     m_ids;
+    QList<QString>          m_topics; // id -> canonical string
+    bool                    m_full = false; // warned about kMaxTopics
+};
+
+#endif // TOPICREGISTRY_H
@@ -0,0 +1,54 @@
+#include "triggercondition.h"
+#include <QDebug>
+
+TriggerCondition TriggerCondition::compile(const QString &condition, const QString &value)
+{
+    TriggerCondition c;
+    c.m_value = value;
+
+    if (condition == "any") {
+        c.m_kind = Any;
+    } else if (condition == "contains") {
+        c.m_kind = Contains;
+        c.m_matcher.setPattern(value);
+    } else if (condition == "equals") {
+        c.m_kind = Equals;
+    } else if (condition == "startsWith") {
+        c.m_kind = StartsWith;
+    } else if (condition == "endsWith") {
+        c.m_kind = EndsWith;
+    } else if (condition == "regex") {
+        c.m_regex.setPattern(value);
+        if (!c.m_regex.isValid()) {
+            qWarning() << "Invalid trigger regex:" << value << c.m_regex.errorString();
+            return TriggerCondition();
+        }
+        // Compile (and JIT) now rather than on the first message
+        c.m_regex.optimize();
+        c.m_kind = Regex;
+    } else {
+        qWarning() << "Unknown trigger condition:" << condition;
+    }
+    return c;
+}
+
+bool TriggerCondition::matches(const QString &payload) const
+{
+    switch (m_kind) {
+    case Any:
+        return true;
+    case Contains:
+        return m_matcher.indexIn(payload) >= 0;
+    case Equals:
+        return payload == m_value;
+    case StartsWith:
+        return payload.startsWith(m_value);
+    case EndsWith:
+        return payload.endsWith(m_value);
+    case Regex:
+        return m_regex.match(payload).hasMatch();
+    case Never:
+        break;
+    }
+    return false;
+}
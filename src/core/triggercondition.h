@@ -0,0 +1,33 @@
+#ifndef TRIGGERCONDITION_H
+#define TRIGGERCONDITION_H
+
+#include <QString>
+#include <QStringMatcher>
+#include <QRegularExpression>
+
+/**
+ * A script's trigger condition ("any", "contains", "equals", "startsWith",
+ * "endsWith", "regex") compiled once when the script is loaded, so that
+ * matching a payload needs no string dispatch or regex construction.
+ * Immutable after compile(); safe to share between threads.
+ */
+class TriggerCondition
+{
+public:
+    enum Kind { Never, Any, Contains, Equals, StartsWith, EndsWith, Regex };
+
+    TriggerCondition() = default; // matches nothing
+
+    static TriggerCondition compile(const QString &condition, const QString &value);
+
+    Kind kind() const { return m_kind; }
+    bool matches(const QString &payload) const;
+
+private:
+    Kind               m_kind = Never;
+    QString            m_value;
+    QStringMatcher     m_matcher; // Contains
+    QRegularExpression m_regex;   // Regex
+};
+
+#endif // TRIGGERCONDITION_H
@@ -0,0 +1,12 @@
+# Headless runner: scripts and message recording without QtWidgets
+QT = core sql network mqtt
+DEFINES += QT_SSL_USE_OPENSSL
+TARGET = MQTT_assistant_headless
+TEMPLATE = app
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+include(../core/core.pri)
+
+SOURCES += \
+    main.cpp
@@ -0,0 +1,83 @@
+#include "core/headlessrunner.h"
+#include "core/logger.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QTimer>
+#include <csignal>
+
+// Set from the signal handler, which may do nothing else async-signal-safe
+static volatile std::sig_atomic_t s_stopRequested = 0;
+
+static void requestStop(int)
+{
+    s_stopRequested = 1;
+}
+
+// Runs the script responder and message recorder without any GUI, using the
+// database (connections, subscriptions, scripts) maintained by the GUI build.
+int main(int argc, char *argv[])
+{
+    qputenv("QT_SSL_USE_OPENSSL", "1");
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("MQTT Assistant");
+    app.setOrganizationName("MQTTAssistant");
+
+    QSettings settings("MQTTAssistant", "MQTT_assistant");
+    QString dbDir = settings.value("database/directory").toString();
+    if (dbDir.isEmpty())
+        dbDir = QCoreApplication::applicationDirPath();
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("MQTT 助手无界面模式：运行脚本并记录消息");
+    parser.addHelpOption();
+    QCommandLineOption dbOption({"d", "database"}, "数据库文件路径", "path",
+                                dbDir + "/mqtt_assistant.db");
+    QCommandLineOption connOption({"c", "connection"}, "只运行指定的连接 ID（可重复）", "id");
+    QCommandLineOption durabilityOption("durability", "写入模式：safe、balanced 或 fast", "profile",
+                                        settings.value("database/durability", "balanced").toString());
+    QCommandLineOption logLevelOption("log-level", "日志级别：trace、debug、info、warning、error 或 off",
+                                      "level", settings.value("debug/logLevel", "info").toString());
+    parser.addOptions({ dbOption, connOption, durabilityOption, logLevelOption });
+    parser.process(app);
+
+    QList<int> connectionIds;
+    for (const QString &id : parser.values(connOption)) {
+        bool ok = false;
+        const int value = id.toInt(&ok);
+        if (!ok) {
+            qWarning().noquote() << "Invalid connection id:" << id;
+            return 2;
+        }
+        connectionIds.append(value);
+    }
+
+    QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(dataDir);
+    Logger::instance().setLevel(Logger::levelFromString(parser.value(logLevelOption)));
+    Logger::instance().start(dataDir + "/mqtt_headless.log");
+
+    HeadlessRunner runner;
+    if (!runner.start(parser.value(dbOption), parser.value(durabilityOption), connectionIds)) {
+        Logger::instance().stop();
+        return 1;
+    }
+
+    // Ctrl+C / service stop: leave the event loop so queued messages are
+    // flushed. Qt cannot be called from the handler, so the flag is polled.
+    std::signal(SIGINT,  requestStop);
+    std::signal(SIGTERM, requestStop);
+    QTimer stopPoll;
+    QObject::connect(&stopPoll, &QTimer::timeout, &app, []() {
+        if (s_stopRequested)
+            QCoreApplication::quit();
+    });
+    stopPoll.start(100);
+
+    const int rc = app.exec();
+    runner.stop();
+    Logger::instance().stop();
+    return rc;
+}
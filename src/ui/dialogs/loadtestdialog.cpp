@@ -0,0 +1,115 @@
+#include "loadtestdialog.h"
+#include <QFormLayout>
+#include <QVBoxLayout>
+#include <QDialogButtonBox>
+#include <QPushButton>
+#include <QLabel>
+
+LoadTestDialog::LoadTestDialog(const CommandConfig &command, QWidget *parent)
+    : QDialog(parent)
+    , m_command(command)
+{
+    setupUi();
+    setWindowTitle("压力测试 - " + command.name);
+}
+
+void LoadTestDialog::setupUi()
+{
+    setMinimumWidth(400);
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+    mainLayout->setSpacing(10);
+
+    QLabel *targetLabel = new QLabel(
+        QString("主题: %1    QoS: %2").arg(m_command.topic).arg(m_command.qos), this);
+    targetLabel->setWordWrap(true);
+    mainLayout->addWidget(targetLabel);
+
+    QFormLayout *form = new QFormLayout();
+    form->setLabelAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    form->setFieldGrowthPolicy(QFormLayout::ExpandingFieldsGrow);
+    form->setSpacing(8);
+
+    m_shapeCombo = new QComboBox(this);
+    m_shapeCombo->addItem("恒定速率", LoadProfile::Constant);
+    m_shapeCombo->addItem("突发",     LoadProfile::Burst);
+    m_shapeCombo->addItem("爬坡",     LoadProfile::Ramp);
+    form->addRow("模式:", m_shapeCombo);
+
+    m_rateSpin = new QSpinBox(this);
+    m_rateSpin->setRange(1, LoadGenerator::kMaxRate);
+    m_rateSpin->setValue(1000);
+    m_rateSpin->setSuffix(" 条/秒");
+    form->addRow("目标速率:", m_rateSpin);
+
+    m_startRateSpin = new QSpinBox(this);
+    m_startRateSpin->setRange(0, LoadGenerator::kMaxRate);
+    m_startRateSpin->setValue(100);
+    m_startRateSpin->setSuffix(" 条/秒");
+    form->addRow("起始速率:", m_startRateSpin);
+
+    m_rampSpin = new QSpinBox(this);
+    m_rampSpin->setRange(1, 3600);
+    m_rampSpin->setValue(10);
+    m_rampSpin->setSuffix(" 秒");
+    form->addRow("爬坡时长:", m_rampSpin);
+
+    m_burstSizeSpin = new QSpinBox(this);
+    m_burstSizeSpin->setRange(1, LoadGenerator::kMaxRate);
+    m_burstSizeSpin->setValue(1000);
+    m_burstSizeSpin->setSuffix(" 条");
+    form->addRow("每次突发:", m_burstSizeSpin);
+
+    m_burstIntervalSpin = new QSpinBox(this);
+    m_burstIntervalSpin->setRange(10, 3600000);
+    m_burstIntervalSpin->setValue(1000);
+    m_burstIntervalSpin->setSuffix(" ms");
+    form->addRow("突发间隔:", m_burstIntervalSpin);
+
+    m_durationSpin = new QSpinBox(this);
+    m_durationSpin->setRange(0, 86400);
+    m_durationSpin->setValue(60);
+    m_durationSpin->setSuffix(" 秒");
+    m_durationSpin->setSpecialValueText("不限");
+    form->addRow("持续时间:", m_durationSpin);
+
+    mainLayout->addLayout(form);
+
+    QDialogButtonBox *bbox = new QDialogButtonBox(
+        QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
+    bbox->button(QDialogButtonBox::Ok)->setText("开始");
+    bbox->button(QDialogButtonBox::Cancel)->setText("取消");
+    mainLayout->addWidget(bbox);
+
+    connect(bbox, &QDialogButtonBox::accepted, this, &QDialog::accept);
+    connect(bbox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    connect(m_shapeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &LoadTestDialog::onShapeChanged);
+    onShapeChanged(m_shapeCombo->currentIndex());
+}
+
+void LoadTestDialog::onShapeChanged(int index)
+{
+    const auto shape = static_cast<LoadProfile::Shape>(m_shapeCombo->itemData(index).toInt());
+    m_rateSpin->setEnabled(shape != LoadProfile::Burst);
+    m_startRateSpin->setEnabled(shape == LoadProfile::Ramp);
+    m_rampSpin->setEnabled(shape == LoadProfile::Ramp);
+    m_burstSizeSpin->setEnabled(shape == LoadProfile::Burst);
+    m_burstIntervalSpin->setEnabled(shape == LoadProfile::Burst);
+}
+
+LoadProfile LoadTestDialog::profile() const
+{
+    LoadProfile p;
+    p.shape           = static_cast<LoadProfile::Shape>(m_shapeCombo->currentData().toInt());
+    p.topic           = m_command.topic;
+    p.payload         = m_command.payload;
+    p.qos             = m_command.qos;
+    p.retain          = m_command.retain;
+    p.rate            = m_rateSpin->value();
+    p.startRate       = m_startRateSpin->value();
+    p.rampMs          = m_rampSpin->value() * 1000;
+    p.burstSize       = m_burstSizeSpin->value();
+    p.burstIntervalMs = m_burstIntervalSpin->value();
+    p.durationMs      = m_durationSpin->value() * 1000;
+    return p;
+}
@@ -0,0 +1,34 @@
+#ifndef LOADTESTDIALOG_H
+#define LOADTESTDIALOG_H
+
+#include <QDialog>
+#include <QComboBox>
+#include <QSpinBox>
+#include "core/models.h"
+#include "core/loadgenerator.h"
+
+class LoadTestDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit LoadTestDialog(const CommandConfig &command, QWidget *parent = nullptr);
+
+    LoadProfile profile() const;
+
+private slots:
+    void onShapeChanged(int index);
+
+private:
+    void setupUi();
+
+    CommandConfig m_command;
+    QComboBox *m_shapeCombo;
+    QSpinBox  *m_rateSpin;
+    QSpinBox  *m_startRateSpin;
+    QSpinBox  *m_rampSpin;
+    QSpinBox  *m_burstSizeSpin;
+    QSpinBox  *m_burstIntervalSpin;
+    QSpinBox  *m_durationSpin;
+};
+
+#endif // LOADTESTDIALOG_H
@@ -64,7 +64,7 @@ void ScriptDialog::setupUi()
 
     m_responsePayloadEdit = new QTextEdit(this);
     m_responsePayloadEdit->setPlaceholderText(
-        "响应内容... 支持 {{timestamp}} {{topic}} {{payload}}");
+        "响应内容... 支持 {{timestamp}} {{topic}} {{payload}} {{payload.字段路径}}");
     m_responsePayloadEdit->setMaximumHeight(80);
     form->addRow("响应内容:", m_responsePayloadEdit);
 
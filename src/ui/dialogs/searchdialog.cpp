@@ -0,0 +1,182 @@
+#include "searchdialog.h"
+#include "core/persistenceworker.h"
+#include "ui/models/monitortablemodel.h"
+#include <QFormLayout>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QDateTime>
+
+SearchDialog::SearchDialog(PersistenceWorker *persistence, bool fullTextIndex, QWidget *parent)
+    : QDialog(parent)
+    , m_persistence(persistence)
+    , m_fullTextIndex(fullTextIndex)
+    , m_generation(0)
+    , m_found(0)
+    , m_running(false)
+{
+    setupUi();
+    setWindowTitle("搜索消息");
+}
+
+void SearchDialog::setupUi()
+{
+    resize(760, 520);
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+    mainLayout->setSpacing(10);
+
+    QFormLayout *form = new QFormLayout();
+    form->setLabelAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    form->setFieldGrowthPolicy(QFormLayout::ExpandingFieldsGrow);
+    form->setSpacing(8);
+
+    m_connectionCombo = new QComboBox(this);
+    form->addRow("连接:", m_connectionCombo);
+
+    m_topicEdit = new QLineEdit(this);
+    m_topicEdit->setPlaceholderText("留空为全部主题，支持 + 和 # 通配符");
+    form->addRow("主题:", m_topicEdit);
+
+    // Time bounds are optional; unchecked means open-ended
+    const QDateTime now = QDateTime::currentDateTime();
+    QHBoxLayout *timeLayout = new QHBoxLayout();
+    m_fromCheck = new QCheckBox("从", this);
+    m_fromEdit  = new QDateTimeEdit(now.addDays(-1), this);
+    m_toCheck   = new QCheckBox("到", this);
+    m_toEdit    = new QDateTimeEdit(now, this);
+    for (QDateTimeEdit *edit : { m_fromEdit, m_toEdit }) {
+        edit->setDisplayFormat("yyyy-MM-dd hh:mm:ss");
+        edit->setCalendarPopup(true);
+        edit->setEnabled(false);
+    }
+    timeLayout->addWidget(m_fromCheck);
+    timeLayout->addWidget(m_fromEdit, 1);
+    timeLayout->addWidget(m_toCheck);
+    timeLayout->addWidget(m_toEdit, 1);
+    form->addRow("时间:", timeLayout);
+
+    m_termsEdit = new QLineEdit(this);
+    m_termsEdit->setPlaceholderText("空格分隔，消息内容须包含每个关键词");
+    form->addRow("内容:", m_termsEdit);
+
+    mainLayout->addLayout(form);
+
+    QHBoxLayout *btnLayout = new QHBoxLayout();
+    m_statusLabel = new QLabel(this);
+    if (!m_fullTextIndex)
+        m_statusLabel->setText("当前 SQLite 不支持全文索引，内容搜索会较慢");
+    m_searchBtn = new QPushButton("搜索", this);
+    m_searchBtn->setDefault(true);
+    m_stopBtn = new QPushButton("停止", this);
+    m_stopBtn->setEnabled(false);
+    btnLayout->addWidget(m_statusLabel, 1);
+    btnLayout->addWidget(m_searchBtn);
+    btnLayout->addWidget(m_stopBtn);
+    mainLayout->addLayout(btnLayout);
+
+    // Same model and row layout as the monitor tab
+    m_resultModel = new MonitorTableModel(this);
+    m_resultModel->setRetention(kMaxResults);
+    m_resultView = new QTableView(this);
+    m_resultView->setModel(m_resultModel);
+    m_resultView->horizontalHeader()->setStretchLastSection(true);
+    m_resultView->setColumnWidth(0, 80);
+    m_resultView->setColumnWidth(1, 75);
+    m_resultView->setColumnWidth(2, 200);
+    m_resultView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_resultView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_resultView->setWordWrap(false);
+    m_resultView->verticalHeader()->setVisible(false);
+    m_resultView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_resultView->verticalHeader()->setDefaultSectionSize(24);
+    mainLayout->addWidget(m_resultView, 1);
+
+    connect(m_fromCheck, &QCheckBox::toggled, m_fromEdit, &QWidget::setEnabled);
+    connect(m_toCheck, &QCheckBox::toggled, m_toEdit, &QWidget::setEnabled);
+    connect(m_searchBtn, &QPushButton::clicked, this, &SearchDialog::onSearch);
+    connect(m_topicEdit, &QLineEdit::returnPressed, this, &SearchDialog::onSearch);
+    connect(m_termsEdit, &QLineEdit::returnPressed, this, &SearchDialog::onSearch);
+    connect(m_stopBtn, &QPushButton::clicked, this, &SearchDialog::onStop);
+    connect(m_resultView, &QTableView::doubleClicked, this, &SearchDialog::onRowDoubleClicked);
+}
+
+void SearchDialog::setConnections(const QList<MqttConnectionConfig> &connections,
+                                  int activeConnectionId)
+{
+    m_connectionCombo->clear();
+    m_connectionCombo->addItem("全部连接", -1);
+    for (const MqttConnectionConfig &config : connections)
+        m_connectionCombo->addItem(config.name, config.id);
+    const int index = m_connectionCombo->findData(activeConnectionId);
+    m_connectionCombo->setCurrentIndex(index >= 0 ? index : 0);
+}
+
+void SearchDialog::onSearch()
+{
+    m_query = MessageSearchQuery();
+    m_query.connectionId = m_connectionCombo->currentData().toInt();
+    m_query.topicFilter  = m_topicEdit->text().trimmed();
+    m_query.terms        = m_termsEdit->text().trimmed();
+    m_query.fromMs       = m_fromCheck->isChecked() ? m_fromEdit->dateTime().toMSecsSinceEpoch() : 0;
+    m_query.toMs         = m_toCheck->isChecked() ? m_toEdit->dateTime().toMSecsSinceEpoch() : 0;
+    m_query.limit        = kPageSize;
+
+    ++m_generation;
+    m_found   = 0;
+    m_running = true;
+    m_resultModel->clear();
+    m_searchBtn->setEnabled(false);
+    m_stopBtn->setEnabled(true);
+    m_statusLabel->setText("正在搜索...");
+    m_clock.start();
+    fetchNextPage();
+}
+
+void SearchDialog::onStop()
+{
+    if (!m_running) return;
+    // A page still in flight is dropped by the generation check
+    ++m_generation;
+    finish(QString("已停止，找到 %1 条").arg(m_found));
+}
+
+void SearchDialog::fetchNextPage()
+{
+    const quint64 generation = m_generation;
+    m_persistence->searchMessages(m_query).then(this,
+        [this, generation](const QList<MessageRecord> &page) {
+            if (m_generation != generation) return;
+
+            // Pages arrive newest first, so appending keeps the order; the
+            // model paints them on its next frame tick
+            m_resultModel->appendMessages(page);
+            m_found += page.size();
+
+            if (page.size() < m_query.limit) {
+                finish(QString("共找到 %1 条，用时 %2 ms").arg(m_found).arg(m_clock.elapsed()));
+                return;
+            }
+            if (m_found >= kMaxResults) {
+                finish(QString("已显示前 %1 条，请缩小搜索范围").arg(m_found));
+                return;
+            }
+            m_statusLabel->setText(QString("已找到 %1 条...").arg(m_found));
+            m_query.beforeId = page.last().id;
+            fetchNextPage();
+        });
+}
+
+void SearchDialog::finish(const QString &status)
+{
+    m_running = false;
+    m_searchBtn->setEnabled(true);
+    m_stopBtn->setEnabled(false);
+    m_statusLabel->setText(status);
+}
+
+void SearchDialog::onRowDoubleClicked(const QModelIndex &index)
+{
+    if (!index.isValid() || index.row() >= m_resultModel->rowCount()) return;
+    emit messageActivated(m_resultModel->message(index.row()),
+                          m_resultModel->payloadText(index.row()));
+}
@@ -0,0 +1,72 @@
+#ifndef SEARCHDIALOG_H
+#define SEARCHDIALOG_H
+
+#include <QDialog>
+#include <QComboBox>
+#include <QLineEdit>
+#include <QCheckBox>
+#include <QDateTimeEdit>
+#include <QPushButton>
+#include <QTableView>
+#include <QLabel>
+#include <QElapsedTimer>
+#include "core/models.h"
+
+class PersistenceWorker;
+class MonitorTableModel;
+
+/**
+ * Non-modal search over stored messages. Results stream in page by page
+ * (newest first) through PersistenceWorker::searchMessages, so the first
+ * matches show up while older pages are still being fetched.
+ */
+class SearchDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    // fullTextIndex: whether the database has the FTS5 payload index; without
+    // it every term is a LIKE scan
+    SearchDialog(PersistenceWorker *persistence, bool fullTextIndex, QWidget *parent = nullptr);
+
+    // Refreshes the connection list; activeConnectionId is preselected
+    void setConnections(const QList<MqttConnectionConfig> &connections, int activeConnectionId);
+
+    static const int kPageSize   = 200;
+    static const int kMaxResults = 10000;
+
+signals:
+    void messageActivated(const MessageRecord &msg, const QString &payloadText);
+
+private slots:
+    void onSearch();
+    void onStop();
+    void onRowDoubleClicked(const QModelIndex &index);
+
+private:
+    void setupUi();
+    void fetchNextPage();
+    void finish(const QString &status);
+
+    PersistenceWorker *m_persistence;
+    bool               m_fullTextIndex;
+    QComboBox         *m_connectionCombo;
+    QLineEdit         *m_topicEdit;
+    QLineEdit         *m_termsEdit;
+    QCheckBox         *m_fromCheck;
+    QDateTimeEdit     *m_fromEdit;
+    QCheckBox         *m_toCheck;
+    QDateTimeEdit     *m_toEdit;
+    QPushButton       *m_searchBtn;
+    QPushButton       *m_stopBtn;
+    QTableView        *m_resultView;
+    MonitorTableModel *m_resultModel;
+    QLabel            *m_statusLabel;
+
+    MessageSearchQuery m_query;       // beforeId advances with each page
+    quint64            m_generation;  // bumped per search; stale pages are dropped
+    int                m_found;
+    bool               m_running;
+    QElapsedTimer      m_clock;
+};
+
+#endif // SEARCHDIALOG_H
@@ -2,17 +2,22 @@
 #include "dialogs/connectiondialog.h"
 #include "dialogs/commanddialog.h"
 #include "dialogs/scriptdialog.h"
+#include "dialogs/searchdialog.h"
 #include "widgets/collapsiblesection.h"
+#include "core/topicregistry.h"
+#include "core/metatypes.h"
 
 #include <QHBoxLayout>
 #include <QVBoxLayout>
 #include <QSplitter>
 #include <QScrollArea>
 #include <QHeaderView>
+#include <QScrollBar>
 #include <QMessageBox>
 #include <QMenuBar>
 #include <QMenu>
 #include <QAction>
+#include <QActionGroup>
 #include <QStatusBar>
 #include <QDateTime>
 #include <QLabel>
@@ -23,10 +28,12 @@
 #include <QFileDialog>
 #include <QSettings>
 #include <QCoreApplication>
+#include <QApplication>
 #include <QPixmap>
 #include <QDialog>
 #include <QTextEdit>
 #include <QDialogButtonBox>
+#include <utility>
 
 // ──────────────────────────────────────────────
 //  Construction
@@ -34,13 +41,21 @@
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
+    , m_persistence(nullptr)
+    , m_persistenceThread(nullptr)
     , m_activeConnectionId(-1)
+    , m_historyCursor(0)
+    , m_historyExhausted(true)
+    , m_historyLoading(false)
+    , m_historyWanted(false)
+    , m_historyGeneration(0)
     , m_titleLabel(nullptr)
+    , m_searchDialog(nullptr)
     , m_toastLabel(nullptr)
     , m_toastTimer(nullptr)
 {
     // Register custom types for cross-thread signal/slot delivery
-    qRegisterMetaType<MqttConnectionConfig>("MqttConnectionConfig");
+    registerCoreMetaTypes();
 
     setWindowTitle("MQTT 助手");
     setMinimumSize(960, 640);
@@ -62,18 +77,84 @@ MainWindow::MainWindow(QWidget *parent)
         settings.setValue("database/directory", dbDir);
     }
 
-    if (!m_db.open(dbDir + "/mqtt_assistant.db"))
+    // Durability profile: "safe", "balanced" (WAL) or "fast"; see DatabaseTuning
+    const QString durability = settings.value("database/durability", "balanced").toString();
+    m_db.setDurabilityProfile(durability);
+
+    const QString dbPath = dbDir + "/mqtt_assistant.db";
+    // Opening may run schema migrations over the stored history
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    const bool dbOpened = m_db.open(dbPath);
+    QApplication::restoreOverrideCursor();
+    if (!dbOpened)
         QMessageBox::critical(this, "数据库错误", "无法打开数据库，请检查存储权限。");
 
     setupMenuBar();
     setupUi();
+
+    // Message writes are batched on a dedicated thread with its own connection
+    m_persistence = new PersistenceWorker();
+    m_persistenceThread = new QThread(this);
+    m_persistence->moveToThread(m_persistenceThread);
+    connect(m_persistenceThread, &QThread::finished, m_persistence, &QObject::deleteLater);
+    connect(m_persistence, &PersistenceWorker::batchWritten, this,
+            [this](int rows, qint64 latencyUs, int backlog) {
+                m_dbStatsLabel->setText(QString("写入 %1 条 · %2 ms · 积压 %3")
+                                            .arg(rows)
+                                            .arg(latencyUs / 1000.0, 0, 'f', 1)
+                                            .arg(backlog));
+                updateDroppedLabel();
+            });
+    connect(m_persistence, &PersistenceWorker::fullTextIndexProgress, this, [this](int percent) {
+        if (percent >= 100) {
+            m_indexLabel->hide();
+            showToast("历史消息全文索引已建立");
+            return;
+        }
+        m_indexLabel->setText(QString("正在建立全文索引 %1%").arg(percent));
+        m_indexLabel->show();
+    });
+    connect(m_persistence, &PersistenceWorker::overflowed, this, [this]() {
+        updateDroppedLabel();
+        showToast("数据库写入跟不上，部分消息未保存");
+    });
+    m_persistenceThread->start();
+    QMetaObject::invokeMethod(m_persistence, "open", Qt::QueuedConnection,
+                              Q_ARG(QString, dbPath), Q_ARG(QString, durability));
+
+    connect(&m_ingestor, &MessageIngestor::messagesReady, this, &MainWindow::onMessagesReady);
+    connect(&m_ingestor, &MessageIngestor::overflowed, this, [this]() {
+        updateDroppedLabel();
+        showToast("消息到达过快，部分消息已丢弃");
+    });
+
+    // Traffic of the active connection, refreshed once per load sample
+    connect(&m_connectionManager, &ConnectionManager::loadsSampled, this, [this]() {
+        if (!m_connectionManager.contains(m_activeConnectionId)) {
+            m_statusLabel->setToolTip(QString());
+            return;
+        }
+        const ConnectionLoad load = m_connectionManager.load(m_activeConnectionId);
+        m_statusLabel->setToolTip(QString("接收 %1 条/秒 · 发送 %2 条/秒\nI/O 线程 %3/%4 · 共 %5 个连接")
+                                      .arg(load.receiveRate, 0, 'f', 1)
+                                      .arg(load.publishRate, 0, 'f', 1)
+                                      .arg(load.threadIndex + 1)
+                                      .arg(m_connectionManager.threadCount())
+                                      .arg(m_connectionManager.count()));
+    });
+
     loadAllData();
 }
 
 MainWindow::~MainWindow()
 {
-    for (int id : m_clients.keys())
+    for (int id : m_connectionManager.connectionIds())
         stopClientThread(id);
+
+    // Flush queued messages before the writer thread goes away
+    QMetaObject::invokeMethod(m_persistence, "close", Qt::BlockingQueuedConnection);
+    m_persistenceThread->quit();
+    m_persistenceThread->wait();
 }
 
 // ──────────────────────────────────────────────
@@ -105,6 +186,24 @@ void MainWindow::setupUi()
     m_statusLabel = new QLabel("未连接", this);
     statusBar()->addWidget(m_statusLabel);
 
+    m_dbStatsLabel = new QLabel(this);
+    m_dbStatsLabel->setStyleSheet("color: #999999; font-size: 11px;");
+    m_dbStatsLabel->setToolTip("最近一次批量写入的行数、耗时与待写入积压");
+    statusBar()->addPermanentWidget(m_dbStatsLabel);
+
+    m_droppedLabel = new QLabel(this);
+    m_droppedLabel->setStyleSheet("color: #E53935; font-size: 11px;");
+    m_droppedLabel->setToolTip("丢弃：界面处理不及、未显示也未保存的消息数\n"
+                               "未保存：写入队列已满时未能保存到数据库的消息数");
+    m_droppedLabel->hide();
+    statusBar()->addPermanentWidget(m_droppedLabel);
+
+    m_indexLabel = new QLabel(this);
+    m_indexLabel->setStyleSheet("color: #999999; font-size: 11px;");
+    m_indexLabel->setToolTip("索引完成前，内容搜索使用较慢的逐条匹配");
+    m_indexLabel->hide();
+    statusBar()->addPermanentWidget(m_indexLabel);
+
     // Designer credit on the right side of the status bar (requirement 4)
     QLabel *designerLabel = new QLabel("Designed by LJJ&YYJ", this);
     designerLabel->setStyleSheet("color: #999999; font-size: 11px; padding-right: 4px;");
@@ -255,29 +354,58 @@ void MainWindow::setupContentArea(QWidget *content)
             this, &MainWindow::onSubscribeRequested);
     connect(m_chatWidget, &ChatWidget::clearHistoryRequested,
             this, &MainWindow::onClearHistoryRequested);
+    connect(m_chatWidget, &ChatWidget::olderHistoryRequested,
+            this, &MainWindow::onOlderHistoryRequested);
 
     // Monitor tab
     QWidget *monitorWidget = new QWidget(content);
     QVBoxLayout *monitorLayout = new QVBoxLayout(monitorWidget);
     monitorLayout->setContentsMargins(4, 4, 4, 4);
 
-    m_monitorTable = new QTableWidget(0, 4, monitorWidget);
-    m_monitorTable->setHorizontalHeaderLabels({"时间", "方向", "主题", "内容"});
-    m_monitorTable->horizontalHeader()->setStretchLastSection(true);
-    m_monitorTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Fixed);
-    m_monitorTable->horizontalHeader()->setSectionResizeMode(1, QHeaderView::Fixed);
-    m_monitorTable->horizontalHeader()->setSectionResizeMode(2, QHeaderView::Interactive);
-    m_monitorTable->setColumnWidth(0, 85);
-    m_monitorTable->setColumnWidth(1, 75);
-    m_monitorTable->setColumnWidth(2, 200);
-    m_monitorTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
-    m_monitorTable->setSelectionBehavior(QAbstractItemView::SelectRows);
-    m_monitorTable->setAlternatingRowColors(false);
-    m_monitorTable->verticalHeader()->setVisible(false);
-    monitorLayout->addWidget(m_monitorTable);
+    // Ring-buffer model; rows arrive in per-frame batches
+    m_monitorModel = new MonitorTableModel(this);
+    m_monitorModel->setRetention(QSettings("MQTTAssistant", "MQTT_assistant")
+                                     .value("monitor/retention", MonitorTableModel::kDefaultRetention)
+                                     .toInt());
+
+    m_monitorView = new QTableView(monitorWidget);
+    m_monitorView->setModel(m_monitorModel);
+    m_monitorView->horizontalHeader()->setStretchLastSection(true);
+    m_monitorView->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Fixed);
+    m_monitorView->horizontalHeader()->setSectionResizeMode(1, QHeaderView::Fixed);
+    m_monitorView->horizontalHeader()->setSectionResizeMode(2, QHeaderView::Interactive);
+    m_monitorView->setColumnWidth(0, 85);
+    m_monitorView->setColumnWidth(1, 75);
+    m_monitorView->setColumnWidth(2, 200);
+    m_monitorView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_monitorView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_monitorView->setAlternatingRowColors(false);
+    m_monitorView->setWordWrap(false);
+    m_monitorView->verticalHeader()->setVisible(false);
+    // Fixed row height: the view never has to measure rows
+    m_monitorView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_monitorView->verticalHeader()->setDefaultSectionSize(24);
+    monitorLayout->addWidget(m_monitorView);
+
+    // Follow new rows only if the user has not scrolled up to read
+    m_monitorAtBottom = true;
+    connect(m_monitorModel, &QAbstractItemModel::rowsAboutToBeInserted, this, [this]() {
+        QScrollBar *bar = m_monitorView->verticalScrollBar();
+        m_monitorAtBottom = bar->value() >= bar->maximum();
+    });
+    connect(m_monitorModel, &QAbstractItemModel::rowsInserted, this, [this]() {
+        if (m_monitorAtBottom)
+            m_monitorView->scrollToBottom();
+    });
+
+    // Scroll-back within a screen of the top pages in older history (value is in rows)
+    connect(m_monitorView->verticalScrollBar(), &QScrollBar::valueChanged, this, [this](int value) {
+        if (value <= m_monitorView->viewport()->height() / m_monitorView->verticalHeader()->defaultSectionSize())
+            onOlderHistoryRequested();
+    });
 
     // Double-click to view full content (requirement 8)
-    connect(m_monitorTable, &QTableWidget::cellDoubleClicked,
+    connect(m_monitorView, &QTableView::doubleClicked,
             this, &MainWindow::onMonitorRowDoubleClicked);
 
     m_tabWidget->addTab(monitorWidget, "监控");
@@ -298,12 +426,46 @@ void MainWindow::setupMenuBar()
     QMenuBar *mb = menuBar();
 
     QMenu *fileMenu = mb->addMenu("文件");
+
+    // Database durability profile, persisted to QSettings. Sync and cache
+    // settings apply live; a journal mode change waits for the next start.
+    QMenu *durabilityMenu = fileMenu->addMenu("数据库写入模式");
+    QActionGroup *durabilityGroup = new QActionGroup(this);
+    const QString currentProfile = QSettings("MQTTAssistant", "MQTT_assistant")
+                                       .value("database/durability", "balanced").toString();
+    const QList<QPair<QString, QString>> profiles = {
+        { "safe",     "安全（完整同步）" },
+        { "balanced", "均衡（WAL）" },
+        { "fast",     "极速（WAL，不同步）" },
+    };
+    for (const auto &p : profiles) {
+        QAction *act = durabilityMenu->addAction(p.second);
+        act->setCheckable(true);
+        act->setChecked(p.first == currentProfile);
+        durabilityGroup->addAction(act);
+        const QString profile = p.first;
+        connect(act, &QAction::triggered, this, [this, profile]() {
+            QSettings("MQTTAssistant", "MQTT_assistant").setValue("database/durability", profile);
+            m_db.setDurabilityProfile(profile);
+            QMetaObject::invokeMethod(m_persistence, "setDurabilityProfile",
+                                      Qt::QueuedConnection, Q_ARG(QString, profile));
+            if (DatabaseTuning::forProfile(profile).journalMode
+                    .compare(m_db.journalMode(), Qt::CaseInsensitive) != 0)
+                showToast("写入模式已保存，日志模式将在重启后生效");
+        });
+    }
+    fileMenu->addSeparator();
+
     QAction *actQuit = fileMenu->addAction("退出");
     connect(actQuit, &QAction::triggered, this, &QMainWindow::close);
 
     QMenu *connMenu = mb->addMenu("连接");
     QAction *actAddConn = connMenu->addAction("新建连接...");
     connect(actAddConn, &QAction::triggered, this, &MainWindow::onAddConnection);
+    connMenu->addSeparator();
+    QAction *actSearch = connMenu->addAction("搜索消息...");
+    actSearch->setShortcut(QKeySequence::Find);
+    connect(actSearch, &QAction::triggered, this, &MainWindow::onSearchMessages);
 
     QMenu *helpMenu = mb->addMenu("帮助");
     QAction *actAbout = helpMenu->addAction("关于");
@@ -318,6 +480,22 @@ void MainWindow::setupMenuBar()
 //  Toast Notification
 // ──────────────────────────────────────────────
 
+void MainWindow::updateDroppedLabel()
+{
+    // Ingest drops are lost entirely; persistence drops are shown but unsaved
+    const int lost    = m_ingestor.droppedCount();
+    const int unsaved = m_persistence->droppedCount();
+    if (lost == 0 && unsaved == 0)
+        return;
+    QStringList parts;
+    if (lost > 0)
+        parts << QString("丢弃 %1 条").arg(lost);
+    if (unsaved > 0)
+        parts << QString("未保存 %1 条").arg(unsaved);
+    m_droppedLabel->setText(parts.join(" · "));
+    m_droppedLabel->show();
+}
+
 void MainWindow::showToast(const QString &message, int durationMs)
 {
     m_toastLabel->setText(message);
@@ -395,32 +573,23 @@ void MainWindow::refreshScriptList(int connectionId)
 //  Subscription helpers
 // ──────────────────────────────────────────────
 
-void MainWindow::subscribeAllForConnection(int connectionId)
+// The client re-subscribes by itself after every (re)connect; keep its
+// copy of the saved list current
+void MainWindow::syncSubscriptions(int connectionId)
 {
-    if (!m_clients.contains(connectionId)) return;
-    MqttClient *client = m_clients[connectionId];
-    if (!client->isConnected()) return;
-    QList<SubscriptionConfig> subs = m_db.loadSubscriptions(connectionId);
-    for (const SubscriptionConfig &s : subs) {
-        QMetaObject::invokeMethod(client, "subscribe", Qt::QueuedConnection,
-                                  Q_ARG(QString, s.topic), Q_ARG(int, s.qos));
-    }
+    MqttClient *client = m_connectionManager.client(connectionId);
+    if (!client) return;
+    QMetaObject::invokeMethod(client, "setSubscriptions",
+                              Qt::QueuedConnection,
+                              Q_ARG(QList<SubscriptionConfig>,
+                                    m_db.loadSubscriptions(connectionId)));
 }
 
 void MainWindow::stopClientThread(int connectionId)
 {
-    if (m_clients.contains(connectionId)) {
-        MqttClient *client = m_clients.take(connectionId);
-        QMetaObject::invokeMethod(client, "disconnectFromHost", Qt::QueuedConnection);
-        if (m_clientThreads.contains(connectionId)) {
-            QThread *thread = m_clientThreads.take(connectionId);
-            // Quit the event loop; client will be deleted via the
-            // QThread::finished -> client->deleteLater() connection.
-            thread->quit();
-            // Do not block with thread->wait() to keep the UI responsive.
-            // The thread and client will clean up asynchronously.
-        }
-    }
+    m_ingestor.detach(connectionId);
+    // Disconnects and deletes the client and its engine on their I/O thread
+    m_connectionManager.remove(connectionId);
     m_unreadCounts.remove(connectionId);
 }
 
@@ -471,10 +640,10 @@ void MainWindow::onDeleteConnection(int connectionId)
         QMessageBox::Yes | QMessageBox::No);
     if (ret != QMessageBox::Yes) return;
 
-    if (m_clients.contains(connectionId)) {
+    if (m_connectionManager.contains(connectionId)) {
         stopClientThread(connectionId);
     }
-    m_db.deleteMessages(connectionId);
+    m_persistence->deleteMessages(connectionId);
     m_db.deleteConnection(connectionId);
     m_connections.remove(connectionId);
     m_connectionPanel->removeConnection(connectionId);
@@ -493,31 +662,11 @@ void MainWindow::onConnectRequested(int connectionId)
     if (!m_connections.contains(connectionId)) return;
     const MqttConnectionConfig &config = m_connections[connectionId];
 
-    // Enforce maximum of 5 simultaneous connections
-    int activeCount = 0;
-    for (auto it = m_clients.begin(); it != m_clients.end(); ++it) {
-        if (it.value()->isConnected()) ++activeCount;
-    }
-    if (activeCount >= 5 && !m_clients.contains(connectionId)) {
-        showToast("最多同时连接 5 个平台");
-        return;
-    }
-
-    if (!m_clients.contains(connectionId)) {
-        // Create client with no parent so it can be moved to a thread
-        MqttClient *client = new MqttClient();
-        QThread *thread = new QThread(this);
-
-        // Move client to its own thread for UI-smooth operation
-        client->moveToThread(thread);
-
-        // Clean up client when thread finishes
-        connect(thread, &QThread::finished, client, &QObject::deleteLater);
-        thread->start();
-
-        m_clients[connectionId]      = client;
-        m_clientThreads[connectionId] = thread;
-        m_unreadCounts[connectionId]  = 0;
+    if (!m_connectionManager.contains(connectionId)) {
+        // The client and its script engine share one of the pooled I/O threads
+        MqttClient *client = m_connectionManager.create(connectionId);
+        m_connectionManager.scriptEngine(connectionId)->setScripts(scriptsForConnection(connectionId));
+        m_unreadCounts[connectionId] = 0;
 
         connect(client, &MqttClient::connected, this, [this, connectionId]() {
             m_connectionPanel->setConnected(connectionId, true);
@@ -527,8 +676,6 @@ void MainWindow::onConnectRequested(int connectionId)
                 m_statusLabel->setText("已连接：" + name);
                 showToast("已连接到 " + name);
             }
-            // Auto-subscribe to saved subscriptions
-            subscribeAllForConnection(connectionId);
         }, Qt::QueuedConnection);
 
         connect(client, &MqttClient::disconnected, this, [this, connectionId]() {
@@ -540,29 +687,31 @@ void MainWindow::onConnectRequested(int connectionId)
             }
         }, Qt::QueuedConnection);
 
-        connect(client, &MqttClient::messageReceived, this,
-                [this, connectionId](const QString &topic, const QString &payload, bool retained) {
-                    if (m_activeConnectionId == connectionId) {
-                        saveAndDisplayMessage(topic, payload, false, connectionId, retained);
-                    } else {
-                        // Save to DB and increment unread badge for inactive connection
-                        if (!retained) {
-                            MessageRecord msg;
-                            msg.connectionId = connectionId;
-                            msg.topic        = topic;
-                            msg.payload      = payload;
-                            msg.outgoing     = false;
-                            msg.retained     = false;
-                            msg.timestamp    = QDateTime::currentDateTime();
-                            m_db.saveMessage(msg);
-
-                            int count = m_unreadCounts.value(connectionId, 0) + 1;
-                            m_unreadCounts[connectionId] = count;
-                            m_connectionPanel->setUnreadCount(connectionId, count);
-                        }
-                    }
+        connect(client, &MqttClient::reconnecting, this,
+                [this, connectionId](int attempt, int delayMs) {
+                    if (m_activeConnectionId == connectionId)
+                        m_statusLabel->setText(QString("连接中断，%1 秒后第 %2 次重连...")
+                                                   .arg(delayMs / 1000.0, 0, 'f', 1)
+                                                   .arg(attempt));
+                }, Qt::QueuedConnection);
+
+        connect(client, &MqttClient::reconnected, this,
+                [this, connectionId](qint64 outageMs) {
+                    if (m_activeConnectionId == connectionId)
+                        showToast(QString("已重新连接，耗时 %1 ms").arg(outageMs));
+                }, Qt::QueuedConnection);
+
+        // Replaces a "reconnecting" status left over from the rejected attempt
+        connect(client, &MqttClient::connectAbandoned, this,
+                [this, connectionId](const QString &reason) {
+                    m_connectionPanel->setConnected(connectionId, false);
+                    if (m_activeConnectionId == connectionId)
+                        m_statusLabel->setText("连接失败：" + reason);
                 }, Qt::QueuedConnection);
 
+        // Received messages reach the GUI in per-frame batches; see onMessagesReady
+        m_ingestor.attach(connectionId, client);
+
         connect(client, &MqttClient::errorOccurred, this,
                 [this, connectionId](const QString &msg) {
                     m_connectionPanel->setLoading(connectionId, false);
@@ -573,22 +722,15 @@ void MainWindow::onConnectRequested(int connectionId)
     // Show loading indicator while connecting
     m_connectionPanel->setLoading(connectionId, true);
 
-    MqttClient *client = m_clients[connectionId];
+    MqttClient *client = m_connectionManager.client(connectionId);
+    // Queued ahead of connectToHost so the first connect already subscribes
+    syncSubscriptions(connectionId);
     // Invoke connectToHost on the client's thread
     QMetaObject::invokeMethod(client, "connectToHost", Qt::QueuedConnection,
                               Q_ARG(MqttConnectionConfig, config));
 
     m_activeConnectionId = connectionId;
 
-    // Build per-connection script set
-    QList<ScriptConfig> connScripts;
-    for (const ScriptConfig &s : m_scripts.values()) {
-        if (s.connectionId == connectionId || s.connectionId == -1)
-            connScripts.append(s);
-    }
-    m_scriptEngine.setClient(client);
-    m_scriptEngine.setScripts(connScripts);
-
     m_commandPanel->setClient(client);
     m_chatWidget->setClient(client);
 
@@ -601,18 +743,13 @@ void MainWindow::onConnectRequested(int connectionId)
     refreshScriptList(connectionId);
 
     // Load message history
-    QList<MessageRecord> history = m_db.loadMessages(connectionId, 100);
-    m_chatWidget->loadMessages(history);
-
-    m_monitorTable->setRowCount(0);
-    for (const MessageRecord &msg : history)
-        addMessageToMonitor(msg);
+    showHistory(connectionId);
 }
 
 void MainWindow::onDisconnectRequested(int connectionId)
 {
-    if (!m_clients.contains(connectionId)) return;
-    MqttClient *client = m_clients[connectionId];
+    MqttClient *client = m_connectionManager.client(connectionId);
+    if (!client) return;
     QMetaObject::invokeMethod(client, "disconnectFromHost", Qt::QueuedConnection);
 }
 
@@ -623,24 +760,15 @@ void MainWindow::onConnectionSelectionChanged(int connectionId)
     m_activeConnectionId = connectionId;
 
     if (m_connections.contains(connectionId)) {
-        bool isConn = m_clients.contains(connectionId) &&
-                      m_clients[connectionId]->isConnected();
+        MqttClient *client = m_connectionManager.client(connectionId);
+        bool isConn = client && client->isConnected();
 
         if (isConn) {
             const QString &name = m_connections[connectionId].name;
             setWindowTitle("MQTT 助手 - " + name);
             m_statusLabel->setText("已连接：" + name);
-            m_commandPanel->setClient(m_clients[connectionId]);
-            m_chatWidget->setClient(m_clients[connectionId]);
-
-            // Update script engine for this connection
-            QList<ScriptConfig> connScripts;
-            for (const ScriptConfig &s : m_scripts.values()) {
-                if (s.connectionId == connectionId || s.connectionId == -1)
-                    connScripts.append(s);
-            }
-            m_scriptEngine.setClient(m_clients[connectionId]);
-            m_scriptEngine.setScripts(connScripts);
+            m_commandPanel->setClient(client);
+            m_chatWidget->setClient(client);
         } else {
             setWindowTitle("MQTT 助手");
             m_statusLabel->setText("未连接");
@@ -661,11 +789,7 @@ void MainWindow::onConnectionSelectionChanged(int connectionId)
         m_subscriptionPanel->loadSubscriptions(subs);
 
         // Load message history
-        QList<MessageRecord> history = m_db.loadMessages(connectionId, 100);
-        m_chatWidget->loadMessages(history);
-        m_monitorTable->setRowCount(0);
-        for (const MessageRecord &msg : history)
-            addMessageToMonitor(msg);
+        showHistory(connectionId);
     }
 }
 
@@ -696,11 +820,11 @@ void MainWindow::onAddSubscription()
     }
     sub.id = id;
     m_subscriptionPanel->addSubscription(sub);
+    syncSubscriptions(m_activeConnectionId);
 
     // Subscribe immediately if connected
-    if (m_clients.contains(m_activeConnectionId) &&
-        m_clients[m_activeConnectionId]->isConnected()) {
-        MqttClient *client = m_clients[m_activeConnectionId];
+    MqttClient *client = m_connectionManager.client(m_activeConnectionId);
+    if (client && client->isConnected()) {
         QMetaObject::invokeMethod(client, "subscribe", Qt::QueuedConnection,
                                   Q_ARG(QString, topic), Q_ARG(int, 0));
     }
@@ -711,10 +835,10 @@ void MainWindow::onUnsubscribeRequested(const QString &topic, int id)
 {
     m_db.deleteSubscription(id);
     m_subscriptionPanel->removeSubscriptionById(id);
+    syncSubscriptions(m_activeConnectionId);
 
-    if (m_clients.contains(m_activeConnectionId) &&
-        m_clients[m_activeConnectionId]->isConnected()) {
-        MqttClient *client = m_clients[m_activeConnectionId];
+    MqttClient *client = m_connectionManager.client(m_activeConnectionId);
+    if (client && client->isConnected()) {
         QMetaObject::invokeMethod(client, "unsubscribe", Qt::QueuedConnection,
                                   Q_ARG(QString, topic));
     }
@@ -792,7 +916,7 @@ void MainWindow::onAddScript()
     }
     script.id = id;
     m_scripts[id] = script;
-    m_scriptEngine.addScript(script);
+    syncScriptEngines(script);
     refreshScriptList(m_activeConnectionId);
     showToast("脚本已添加：" + script.name);
 }
@@ -807,7 +931,7 @@ void MainWindow::onEditScript(int scriptId)
     updated.connectionId     = m_scripts[scriptId].connectionId;
     m_db.updateScript(updated);
     m_scripts[scriptId]      = updated;
-    m_scriptEngine.updateScript(updated);
+    syncScriptEngines(updated);
     refreshScriptList(m_activeConnectionId);
     showToast("脚本已更新");
 }
@@ -819,7 +943,8 @@ void MainWindow::onDeleteScript(int scriptId)
     if (ret != QMessageBox::Yes) return;
     m_db.deleteScript(scriptId);
     m_scripts.remove(scriptId);
-    m_scriptEngine.removeScript(scriptId);
+    for (int id : m_connectionManager.connectionIds())
+        m_connectionManager.scriptEngine(id)->removeScript(scriptId);
     refreshScriptList(m_activeConnectionId);
     showToast("脚本已删除");
 }
@@ -832,7 +957,7 @@ void MainWindow::onScriptItemChanged(QListWidgetItem *item)
     bool enabled = (item->checkState() == Qt::Checked);
     m_scripts[id].enabled = enabled;
     m_db.updateScript(m_scripts[id]);
-    m_scriptEngine.updateScript(m_scripts[id]);
+    syncScriptEngines(m_scripts[id]);
 }
 
 // ──────────────────────────────────────────────
@@ -841,29 +966,21 @@ void MainWindow::onScriptItemChanged(QListWidgetItem *item)
 
 void MainWindow::onSendRequested(const QString &topic, const QString &payload)
 {
-    if (m_activeConnectionId < 0 || !m_clients.contains(m_activeConnectionId)) {
-        showToast("请先连接到 MQTT 服务器");
-        return;
-    }
-    MqttClient *client = m_clients[m_activeConnectionId];
-    if (!client->isConnected()) {
+    MqttClient *client = m_connectionManager.client(m_activeConnectionId);
+    if (!client || !client->isConnected()) {
         showToast("请先连接到 MQTT 服务器");
         return;
     }
     QMetaObject::invokeMethod(client, "publish", Qt::QueuedConnection,
                               Q_ARG(QString, topic), Q_ARG(QString, payload),
                               Q_ARG(int, 0), Q_ARG(bool, false));
-    saveAndDisplayMessage(topic, payload, true, m_activeConnectionId);
+    saveAndDisplayMessage(topic, payload.toUtf8(), true, m_activeConnectionId);
 }
 
 void MainWindow::onSubscribeRequested(const QString &topic)
 {
-    if (m_activeConnectionId < 0 || !m_clients.contains(m_activeConnectionId)) {
-        showToast("请先连接到 MQTT 服务器");
-        return;
-    }
-    MqttClient *client = m_clients[m_activeConnectionId];
-    if (!client->isConnected()) {
+    MqttClient *client = m_connectionManager.client(m_activeConnectionId);
+    if (!client || !client->isConnected()) {
         showToast("请先连接到 MQTT 服务器");
         return;
     }
@@ -885,6 +1002,7 @@ void MainWindow::onSubscribeRequested(const QString &topic)
         if (id >= 0) {
             sub.id = id;
             m_subscriptionPanel->addSubscription(sub);
+            syncSubscriptions(m_activeConnectionId);
         }
     }
     showToast("已订阅：" + topic);
@@ -894,48 +1012,151 @@ void MainWindow::onSubscribeRequested(const QString &topic)
 //  Helpers
 // ──────────────────────────────────────────────
 
-void MainWindow::saveAndDisplayMessage(const QString &topic, const QString &payload,
+void MainWindow::saveAndDisplayMessage(const QString &topic, const QByteArray &payload,
                                        bool outgoing, int connectionId, bool retained)
 {
     MessageRecord msg;
     msg.connectionId = connectionId;
-    msg.topic        = topic;
+    msg.topic        = TopicRegistry::instance().intern(topic, &msg.topicId);
     msg.payload      = payload;
     msg.outgoing     = outgoing;
     msg.retained     = retained;
-    msg.timestamp    = QDateTime::currentDateTime();
+    msg.timestampMs  = QDateTime::currentMSecsSinceEpoch();
 
     // Do not persist retained messages to avoid duplicate history on reconnect
-    if (!retained) {
-        int id = m_db.saveMessage(msg);
-        msg.id = id;
-    }
+    if (!retained)
+        persistMessage(msg);
 
     m_chatWidget->addMessage(msg);
-    addMessageToMonitor(msg);
+    m_monitorModel->appendMessage(msg);
 }
 
-void MainWindow::addMessageToMonitor(const MessageRecord &msg)
+void MainWindow::onMessagesReady(int connectionId, const QList<MessageRecord> &messages)
 {
-    int row = m_monitorTable->rowCount();
-    m_monitorTable->insertRow(row);
+    // Do not persist retained messages to avoid duplicate history on reconnect
+    int fresh = 0;
+    for (const MessageRecord &msg : messages) {
+        if (!msg.retained) {
+            persistMessage(msg);
+            ++fresh;
+        }
+    }
 
-    m_monitorTable->setItem(row, 0, new QTableWidgetItem(
-        msg.timestamp.toString("hh:mm:ss")));
-    m_monitorTable->setItem(row, 1, new QTableWidgetItem(
-        msg.outgoing ? "↑ 发送" : "↓ 接收"));
-    m_monitorTable->setItem(row, 2, new QTableWidgetItem(msg.topic));
-    m_monitorTable->setItem(row, 3, new QTableWidgetItem(msg.payload));
+    if (m_activeConnectionId == connectionId) {
+        m_chatWidget->addMessages(messages);
+        m_monitorModel->appendMessages(messages);
+    } else if (fresh > 0) {
+        // Inactive connection: only bump the unread badge
+        int count = m_unreadCounts.value(connectionId, 0) + fresh;
+        m_unreadCounts[connectionId] = count;
+        m_connectionPanel->setUnreadCount(connectionId, count);
+    }
+}
+
+QList<ScriptConfig> MainWindow::scriptsForConnection(int connectionId) const
+{
+    QList<ScriptConfig> scripts;
+    for (const ScriptConfig &s : m_scripts) {
+        if (s.connectionId == connectionId || s.connectionId == -1)
+            scripts.append(s);
+    }
+    return scripts;
+}
 
-    QColor dirColor = msg.outgoing ? QColor("#ea5413") : QColor("#1e9e50");
-    m_monitorTable->item(row, 1)->setForeground(dirColor);
+void MainWindow::syncScriptEngines(const ScriptConfig &script)
+{
+    // Global scripts (connectionId -1) apply to every live connection
+    for (int id : m_connectionManager.connectionIds()) {
+        ScriptEngine *engine = m_connectionManager.scriptEngine(id);
+        if (script.connectionId == id || script.connectionId == -1)
+            engine->updateScript(script);
+        else
+            engine->removeScript(script.id);
+    }
+}
 
-    m_monitorTable->scrollToBottom();
+void MainWindow::persistMessage(const MessageRecord &msg)
+{
+    // Fall back to a direct write if the worker is not running yet
+    if (!m_persistence->enqueue(msg))
+        m_db.saveMessage(msg);
+}
+
+void MainWindow::showHistory(int connectionId)
+{
+    const quint64 generation = ++m_historyGeneration;
+    m_historyCursor    = 0;
+    m_historyExhausted = true;
+    m_historyLoading   = false;
+    m_historyWanted    = false;
+    m_historyPrefetch.clear();
+
+    m_persistence->loadMessages(connectionId, kHistoryPageSize).then(this,
+        [this, connectionId, generation](const QList<MessageRecord> &history) {
+            // The user may have switched connections while the query ran
+            if (m_activeConnectionId != connectionId || m_historyGeneration != generation) return;
+            m_chatWidget->loadMessages(history);
+            m_monitorModel->setMessages(history);
+            // A reset leaves the view at the top; open at the newest message
+            m_monitorAtBottom = true;
+            m_monitorView->scrollToBottom();
+
+            m_historyExhausted = history.size() < kHistoryPageSize;
+            if (!history.isEmpty())
+                m_historyCursor = history.first().id;
+            fetchOlderHistory(); // prefetch the first scroll-back page
+        });
+}
+
+void MainWindow::fetchOlderHistory()
+{
+    if (m_historyLoading || m_historyExhausted || m_historyCursor <= 0
+        || !m_historyPrefetch.isEmpty())
+        return;
+
+    m_historyLoading = true;
+    const int connectionId    = m_activeConnectionId;
+    const quint64 generation  = m_historyGeneration;
+    m_persistence->loadMessagesBefore(connectionId, m_historyCursor, kHistoryPageSize).then(this,
+        [this, connectionId, generation](const QList<MessageRecord> &page) {
+            if (m_activeConnectionId != connectionId || m_historyGeneration != generation) return;
+            m_historyLoading   = false;
+            m_historyExhausted = page.size() < kHistoryPageSize;
+            if (!page.isEmpty())
+                m_historyCursor = page.first().id;
+            m_historyPrefetch = page;
+            if (m_historyWanted) {
+                m_historyWanted = false;
+                onOlderHistoryRequested();
+            }
+        });
+}
+
+void MainWindow::onOlderHistoryRequested()
+{
+    if (m_historyPrefetch.isEmpty()) {
+        // Show the page as soon as it arrives
+        m_historyWanted = m_historyLoading || !m_historyExhausted;
+        fetchOlderHistory();
+        return;
+    }
+
+    const QList<MessageRecord> page = std::exchange(m_historyPrefetch, QList<MessageRecord>());
+    m_chatWidget->prependMessages(page);
+
+    // Keep the monitor's top row in place as well
+    const QModelIndex anchor = m_monitorView->indexAt(QPoint(0, 0));
+    const int inserted = m_monitorModel->prependMessages(page);
+    if (inserted > 0 && anchor.isValid() && !m_monitorAtBottom)
+        m_monitorView->scrollTo(m_monitorModel->index(anchor.row() + inserted, 0),
+                                QAbstractItemView::PositionAtTop);
+
+    fetchOlderHistory(); // and prefetch the next one
 }
 
 MqttClient *MainWindow::clientForId(int connectionId)
 {
-    return m_clients.value(connectionId, nullptr);
+    return m_connectionManager.client(connectionId);
 }
 
 MqttConnectionConfig MainWindow::configForId(int connectionId) const
@@ -960,9 +1181,14 @@ ScriptConfig MainWindow::scriptConfigForId(int scriptId) const
 void MainWindow::onClearHistoryRequested(int connectionId)
 {
     if (connectionId >= 0)
-        m_db.deleteMessages(connectionId);
+        m_persistence->deleteMessages(connectionId);
     // Also clear the monitor table so it reflects the cleared state
-    m_monitorTable->setRowCount(0);
+    m_monitorModel->clear();
+    // Nothing older is left to page in
+    ++m_historyGeneration;
+    m_historyExhausted = true;
+    m_historyWanted    = false;
+    m_historyPrefetch.clear();
     showToast("聊天记录已清除");
 }
 
@@ -970,14 +1196,19 @@ void MainWindow::onClearHistoryRequested(int connectionId)
 //  Monitor Row Double-Click (Requirement 8)
 // ──────────────────────────────────────────────
 
-void MainWindow::onMonitorRowDoubleClicked(int row, int /*col*/)
+void MainWindow::onMonitorRowDoubleClicked(const QModelIndex &index)
 {
-    if (row < 0 || row >= m_monitorTable->rowCount()) return;
+    if (!index.isValid() || index.row() >= m_monitorModel->rowCount()) return;
+    showMessageDetails(m_monitorModel->message(index.row()),
+                       m_monitorModel->payloadText(index.row()));
+}
 
-    QString time    = m_monitorTable->item(row, 0) ? m_monitorTable->item(row, 0)->text() : QString();
-    QString dir     = m_monitorTable->item(row, 1) ? m_monitorTable->item(row, 1)->text() : QString();
-    QString topic   = m_monitorTable->item(row, 2) ? m_monitorTable->item(row, 2)->text() : QString();
-    QString payload = m_monitorTable->item(row, 3) ? m_monitorTable->item(row, 3)->text() : QString();
+void MainWindow::showMessageDetails(const MessageRecord &msg, const QString &payloadText)
+{
+    // Search results can span days, so the date is shown too
+    QString time  = msg.timestamp().toString("yyyy-MM-dd hh:mm:ss");
+    QString dir   = msg.outgoing ? "↑ 发送" : "↓ 接收";
+    QString topic = msg.topic;
 
     QDialog dlg(this);
     dlg.setWindowTitle("消息详情");
@@ -992,7 +1223,7 @@ void MainWindow::onMonitorRowDoubleClicked(int row, int /*col*/)
     layout->addWidget(infoLabel);
 
     QTextEdit *contentEdit = new QTextEdit(&dlg);
-    contentEdit->setPlainText(payload);
+    contentEdit->setPlainText(payloadText);
     contentEdit->setReadOnly(true);
     layout->addWidget(contentEdit);
 
@@ -1004,6 +1235,19 @@ void MainWindow::onMonitorRowDoubleClicked(int row, int /*col*/)
     dlg.exec();
 }
 
+void MainWindow::onSearchMessages()
+{
+    if (!m_searchDialog) {
+        m_searchDialog = new SearchDialog(m_persistence, m_db.hasFullTextIndex(), this);
+        connect(m_searchDialog, &SearchDialog::messageActivated,
+                this, &MainWindow::showMessageDetails);
+    }
+    m_searchDialog->setConnections(m_connections.values(), m_activeConnectionId);
+    m_searchDialog->show();
+    m_searchDialog->raise();
+    m_searchDialog->activateWindow();
+}
+
 // ──────────────────────────────────────────────
 //  Sidebar Title (Requirement 6)
 // ──────────────────────────────────────────────
@@ -3,7 +3,7 @@
 
 #include <QMainWindow>
 #include <QListWidget>
-#include <QTableWidget>
+#include <QTableView>
 #include <QTabWidget>
 #include <QLabel>
 #include <QPushButton>
@@ -14,11 +14,17 @@
 #include "core/models.h"
 #include "core/mqttclient.h"
 #include "core/databasemanager.h"
+#include "core/persistenceworker.h"
+#include "core/messageingestor.h"
 #include "core/scriptengine.h"
+#include "core/connectionmanager.h"
 #include "widgets/connectionpanel.h"
 #include "widgets/commandpanel.h"
 #include "widgets/chatwidget.h"
 #include "widgets/subscriptionpanel.h"
+#include "models/monitortablemodel.h"
+
+class SearchDialog;
 
 class MainWindow : public QMainWindow
 {
@@ -60,7 +66,16 @@ private slots:
     void onClearHistoryRequested(int connectionId);
 
     // Monitor table
-    void onMonitorRowDoubleClicked(int row, int col);
+    void onMonitorRowDoubleClicked(const QModelIndex &index);
+
+    // Full-text search over stored messages
+    void onSearchMessages();
+
+    // Scroll-back: show the prefetched page and fetch the one after it
+    void onOlderHistoryRequested();
+
+    // Batched inbound messages from all client threads
+    void onMessagesReady(int connectionId, const QList<MessageRecord> &messages);
 
 private:
     void setupUi();
@@ -70,11 +85,16 @@ private:
     void loadAllData();
     void refreshCommandPanel(int connectionId);
     void refreshScriptList(int connectionId);
-    void addMessageToMonitor(const MessageRecord &msg);
-    void saveAndDisplayMessage(const QString &topic, const QString &payload,
+    void persistMessage(const MessageRecord &msg);
+    QList<ScriptConfig> scriptsForConnection(int connectionId) const;
+    void syncScriptEngines(const ScriptConfig &script);
+    void showHistory(int connectionId);
+    void fetchOlderHistory();
+    void saveAndDisplayMessage(const QString &topic, const QByteArray &payload,
                                bool outgoing, int connectionId, bool retained = false);
     void showToast(const QString &message, int durationMs = 2500);
-    void subscribeAllForConnection(int connectionId);
+    void updateDroppedLabel();
+    void syncSubscriptions(int connectionId);
     void updateSidebarTitle();
     void stopClientThread(int connectionId);
 
@@ -82,29 +102,47 @@ private:
     MqttConnectionConfig configForId(int connectionId) const;
     CommandConfig    commandConfigForId(int commandId) const;
     ScriptConfig     scriptConfigForId(int scriptId) const;
+    void showMessageDetails(const MessageRecord &msg, const QString &payloadText);
 
     // Data
     DatabaseManager  m_db;
+    PersistenceWorker *m_persistence;       // message writes, off the GUI thread
+    QThread           *m_persistenceThread;
+    MessageIngestor    m_ingestor;          // client threads -> GUI, once per frame
     QMap<int, MqttConnectionConfig> m_connections; // id -> config
     QMap<int, CommandConfig>        m_commands;    // id -> config
     QMap<int, ScriptConfig>         m_scripts;     // id -> config
-    QMap<int, MqttClient*>          m_clients;     // connectionId -> client
-    QMap<int, QThread*>             m_clientThreads; // connectionId -> thread
     QMap<int, int>                  m_unreadCounts;  // connectionId -> unread count
-    ScriptEngine                    m_scriptEngine;
+    // Declared after m_ingestor so clients are gone before the ingestor is
+    ConnectionManager  m_connectionManager; // clients and engines on pooled I/O threads
 
     int m_activeConnectionId;
 
+    // Keyset paging through the active connection's stored history
+    static const int kHistoryPageSize = 100;
+    int                  m_historyCursor;     // oldest message id shown; pages load below it
+    bool                 m_historyExhausted;
+    bool                 m_historyLoading;
+    bool                 m_historyWanted;     // the user reached the top while a page was loading
+    quint64              m_historyGeneration; // bumped on reload so stale pages are ignored
+    QList<MessageRecord> m_historyPrefetch;   // next page, ready before it is needed
+
     // UI widgets
     ConnectionPanel   *m_connectionPanel;
     SubscriptionPanel *m_subscriptionPanel;
     CommandPanel      *m_commandPanel;
     QListWidget       *m_scriptList;
     ChatWidget        *m_chatWidget;
-    QTableWidget      *m_monitorTable;
+    QTableView        *m_monitorView;
+    MonitorTableModel *m_monitorModel;
+    bool               m_monitorAtBottom; // sampled before each batch insert
     QTabWidget        *m_tabWidget;
     QLabel            *m_statusLabel;
+    QLabel            *m_dbStatsLabel;
+    QLabel            *m_droppedLabel;  // hidden until messages are lost
+    QLabel            *m_indexLabel;    // shown while history is being indexed
     QLabel            *m_titleLabel; // sidebar title (image or text)
+    SearchDialog      *m_searchDialog; // created on first use, kept for its results
 
     // Toast
     QLabel  *m_toastLabel;
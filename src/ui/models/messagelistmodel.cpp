@@ -0,0 +1,94 @@
+#include "messagelistmodel.h"
+#include "core/payloadformat.h"
+
+MessageListModel::MessageListModel(QObject *parent)
+    : QAbstractListModel(parent)
+    , m_rows(kDefaultCapacity)
+{
+}
+
+int MessageListModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_rows.size();
+}
+
+QVariant MessageListModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rows.size())
+        return QVariant();
+    const MessageRecord &msg = m_rows.at(index.row()).msg;
+    switch (role) {
+    case Qt::DisplayRole:
+        return PayloadFormat::toDisplayText(msg.payload);
+    case Qt::ToolTipRole:
+        return msg.topic;
+    default:
+        return QVariant();
+    }
+}
+
+void MessageListModel::appendMessages(const QList<MessageRecord> &messages)
+{
+    if (messages.isEmpty())
+        return;
+
+    // Only the newest 'capacity' messages of the batch can survive
+    const int cap   = m_rows.capacity();
+    const int skip  = qMax(0, static_cast<int>(messages.size()) - cap);
+    const int count = static_cast<int>(messages.size()) - skip;
+
+    // Evict first, with one remove notification for the whole overflow
+    const int overflow = m_rows.size() + count - cap;
+    if (overflow > 0) {
+        beginRemoveRows(QModelIndex(), 0, overflow - 1);
+        m_rows.removeFirst(overflow);
+        endRemoveRows();
+    }
+
+    const int first = m_rows.size();
+    beginInsertRows(QModelIndex(), first, first + count - 1);
+    for (int i = skip; i < messages.size(); ++i) {
+        ChatRow row;
+        row.msg = messages.at(i);
+        m_rows.append(std::move(row));
+    }
+    endInsertRows();
+}
+
+int MessageListModel::prependMessages(const QList<MessageRecord> &messages)
+{
+    const int count = qMin(static_cast<int>(messages.size()), m_rows.capacity() - m_rows.size());
+    if (count <= 0)
+        return 0;
+
+    beginInsertRows(QModelIndex(), 0, count - 1);
+    for (int i = messages.size() - 1; i >= messages.size() - count; --i) {
+        ChatRow row;
+        row.msg = messages.at(i);
+        m_rows.prepend(std::move(row));
+    }
+    endInsertRows();
+    return count;
+}
+
+void MessageListModel::clear()
+{
+    beginResetModel();
+    m_rows.clear();
+    endResetModel();
+}
+
+void MessageListModel::setCapacity(int capacity)
+{
+    beginResetModel();
+    m_rows.setCapacity(capacity);
+    endResetModel();
+}
+
+void MessageListModel::invalidateLayout()
+{
+    for (int i = 0; i < m_rows.size(); ++i)
+        m_rows.at(i).hintWidth = -1;
+    if (!m_rows.isEmpty())
+        emit layoutChanged();
+}
@@ -0,0 +1,58 @@
+#ifndef MESSAGELISTMODEL_H
+#define MESSAGELISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QSize>
+#include "core/models.h"
+#include "core/circularbuffer.h"
+
+// One chat row plus text and geometry derived from it on first paint.
+// Everything after 'msg' is a cache owned by MessageBubbleDelegate.
+struct ChatRow {
+    MessageRecord msg;
+    mutable bool    formatted = false;
+    mutable QString displayText; // pretty-printed JSON or decoded payload
+    mutable QString tagText;     // "[JSON]" / "[TEXT]" / "[HEX]" (+ retained)
+    mutable QString timeText;
+    mutable int     hintWidth = -1; // view width the sizes below were computed for
+    mutable QSize   sizeHint;
+    mutable int     bubbleWidth = 0;
+    mutable QSize   topicSize;
+    mutable QSize   payloadSize;
+};
+
+/**
+ * Chat history backed by a fixed-capacity ring buffer. Appending to a full
+ * model evicts the oldest rows, so memory stays bounded no matter how long
+ * a connection runs.
+ */
+class MessageListModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    static const int kDefaultCapacity = 100000;
+
+    explicit MessageListModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    const ChatRow &row(int i) const { return m_rows.at(i); }
+
+    void appendMessages(const QList<MessageRecord> &messages);
+    // Inserts older history (oldest first) above the current rows. Never
+    // evicts: returns how many fit, taking the newest ones of the list.
+    int prependMessages(const QList<MessageRecord> &messages);
+    void clear();
+
+    int capacity() const { return m_rows.capacity(); }
+    void setCapacity(int capacity); // also clears
+
+    // Drops cached size hints, e.g. after a font change
+    void invalidateLayout();
+
+private:
+    CircularBuffer<ChatRow> m_rows;
+};
+
+#endif // MESSAGELISTMODEL_H
@@ -0,0 +1,160 @@
+#include "monitortablemodel.h"
+#include "core/payloadformat.h"
+#include <QColor>
+
+MonitorTableModel::MonitorTableModel(QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_rows(kDefaultRetention)
+{
+    m_frameTimer.setSingleShot(true);
+    m_frameTimer.setInterval(kFrameIntervalMs);
+    connect(&m_frameTimer, &QTimer::timeout, this, &MonitorTableModel::flushPending);
+}
+
+int MonitorTableModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_rows.size();
+}
+
+int MonitorTableModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+void MonitorTableModel::ensureText(const Row &row) const
+{
+    if (row.timeText.isEmpty()) {
+        row.timeText    = row.msg.timestamp().toString("hh:mm:ss");
+        row.payloadText = PayloadFormat::toDisplayText(row.msg.payload);
+    }
+}
+
+QString MonitorTableModel::payloadText(int row) const
+{
+    const Row &r = m_rows.at(row);
+    ensureText(r);
+    return r.payloadText;
+}
+
+QVariant MonitorTableModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rows.size())
+        return QVariant();
+    const Row &row = m_rows.at(index.row());
+
+    if (role == Qt::DisplayRole) {
+        ensureText(row);
+        switch (index.column()) {
+        case TimeColumn:      return row.timeText;
+        case DirectionColumn: return row.msg.outgoing ? "↑ 发送" : "↓ 接收";
+        case TopicColumn:     return row.msg.topic;
+        case PayloadColumn:   return row.payloadText;
+        default:              return QVariant();
+        }
+    }
+    if (role == Qt::ForegroundRole && index.column() == DirectionColumn)
+        return row.msg.outgoing ? QColor("#ea5413") : QColor("#1e9e50");
+    return QVariant();
+}
+
+QVariant MonitorTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+        return QVariant();
+    switch (section) {
+    case TimeColumn:      return "时间";
+    case DirectionColumn: return "方向";
+    case TopicColumn:     return "主题";
+    case PayloadColumn:   return "内容";
+    default:              return QVariant();
+    }
+}
+
+void MonitorTableModel::appendMessage(const MessageRecord &msg)
+{
+    m_pending.append(msg);
+    if (!m_frameTimer.isActive())
+        m_frameTimer.start();
+}
+
+void MonitorTableModel::appendMessages(const QList<MessageRecord> &messages)
+{
+    if (messages.isEmpty())
+        return;
+    m_pending.append(messages);
+    if (!m_frameTimer.isActive())
+        m_frameTimer.start();
+}
+
+void MonitorTableModel::flushPending()
+{
+    if (m_pending.isEmpty())
+        return;
+
+    // Only the newest 'retention' rows of the backlog can survive
+    const int cap   = m_rows.capacity();
+    const int skip  = qMax(0, static_cast<int>(m_pending.size()) - cap);
+    const int count = static_cast<int>(m_pending.size()) - skip;
+
+    const int overflow = m_rows.size() + count - cap;
+    if (overflow > 0) {
+        beginRemoveRows(QModelIndex(), 0, overflow - 1);
+        m_rows.removeFirst(overflow);
+        endRemoveRows();
+    }
+
+    const int first = m_rows.size();
+    beginInsertRows(QModelIndex(), first, first + count - 1);
+    for (int i = skip; i < m_pending.size(); ++i) {
+        Row row;
+        row.msg = m_pending.at(i);
+        m_rows.append(std::move(row));
+    }
+    endInsertRows();
+    m_pending.clear();
+}
+
+int MonitorTableModel::prependMessages(const QList<MessageRecord> &messages)
+{
+    const int count = qMin(static_cast<int>(messages.size()), m_rows.capacity() - m_rows.size());
+    if (count <= 0)
+        return 0;
+
+    beginInsertRows(QModelIndex(), 0, count - 1);
+    for (int i = messages.size() - 1; i >= messages.size() - count; --i) {
+        Row row;
+        row.msg = messages.at(i);
+        m_rows.prepend(std::move(row));
+    }
+    endInsertRows();
+    return count;
+}
+
+void MonitorTableModel::setMessages(const QList<MessageRecord> &messages)
+{
+    m_frameTimer.stop();
+    m_pending.clear();
+    beginResetModel();
+    m_rows.clear();
+    const int skip = qMax(0, static_cast<int>(messages.size()) - m_rows.capacity());
+    for (int i = skip; i < messages.size(); ++i) {
+        Row row;
+        row.msg = messages.at(i);
+        m_rows.append(std::move(row));
+    }
+    endResetModel();
+}
+
+void MonitorTableModel::clear()
+{
+    setMessages({});
+}
+
+void MonitorTableModel::setRetention(int rows)
+{
+    m_frameTimer.stop();
+    m_pending.clear();
+    beginResetModel();
+    m_rows.setCapacity(rows);
+    endResetModel();
+}
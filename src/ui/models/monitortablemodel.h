@@ -0,0 +1,66 @@
+#ifndef MONITORTABLEMODEL_H
+#define MONITORTABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QList>
+#include <QTimer>
+#include "core/models.h"
+#include "core/circularbuffer.h"
+
+/**
+ * Monitor tab model: the last 'retention' messages in a ring buffer.
+ * Messages handed to appendMessage() are held back and inserted once per
+ * frame with a single beginInsertRows(), so a fast feed costs one model
+ * update per tick rather than one per message.
+ */
+class MonitorTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    enum Column { TimeColumn, DirectionColumn, TopicColumn, PayloadColumn, ColumnCount };
+
+    static const int kDefaultRetention = 10000;
+    static const int kFrameIntervalMs  = 16;
+
+    explicit MonitorTableModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const override;
+
+    const MessageRecord &message(int row) const { return m_rows.at(row).msg; }
+    QString payloadText(int row) const;
+
+    // Queued until the next frame tick
+    void appendMessage(const MessageRecord &msg);
+    void appendMessages(const QList<MessageRecord> &messages);
+    // Inserts older history (oldest first) above the current rows; returns
+    // how many fit within the retention
+    int prependMessages(const QList<MessageRecord> &messages);
+    // Replaces the contents immediately (history load)
+    void setMessages(const QList<MessageRecord> &messages);
+    void clear();
+
+    int retention() const { return m_rows.capacity(); }
+    void setRetention(int rows); // also clears
+
+public slots:
+    void flushPending();
+
+private:
+    struct Row {
+        MessageRecord msg;
+        mutable QString timeText;    // built on first display
+        mutable QString payloadText;
+    };
+
+    void ensureText(const Row &row) const;
+
+    CircularBuffer<Row>  m_rows;
+    QList<MessageRecord> m_pending;
+    QTimer               m_frameTimer;
+};
+
+#endif // MONITORTABLEMODEL_H
@@ -1,17 +1,23 @@
 #include "chatwidget.h"
-#include "messagebubbleitem.h"
+#include "messagebubbledelegate.h"
+#include "ui/models/messagelistmodel.h"
 #include "core/mqttclient.h"
-#include <QScrollBar>
+#include "core/payloadformat.h"
 #include <QTimer>
+#include <QScrollBar>
 #include <QLabel>
 #include <QFrame>
 #include <QHBoxLayout>
 #include <QCheckBox>
 #include <QMessageBox>
 #include <QSettings>
+#include <QMenu>
+#include <QClipboard>
+#include <QApplication>
 
 ChatWidget::ChatWidget(QWidget *parent)
     : QWidget(parent)
+    , m_scrollPending(false)
     , m_client(nullptr)
     , m_connectionId(-1)
 {
@@ -24,23 +30,35 @@ ChatWidget::ChatWidget(QWidget *parent)
     m_splitter->setHandleWidth(5);
     m_splitter->setChildrenCollapsible(false);
 
-    // Scroll area for messages
-    m_scrollArea = new QScrollArea(m_splitter);
-    m_scrollArea->setWidgetResizable(true);
-    m_scrollArea->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    m_scrollArea->setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
-
-    m_messagesContainer = new QWidget();
-    m_messagesContainer->setObjectName("messagesContainer");
-    m_messagesContainer->setStyleSheet("background-color: #f5f5f5;");
-
-    m_messagesLayout = new QVBoxLayout(m_messagesContainer);
-    m_messagesLayout->setContentsMargins(4, 4, 4, 4);
-    m_messagesLayout->setSpacing(4);
-    m_messagesLayout->addStretch();
-
-    m_scrollArea->setWidget(m_messagesContainer);
-    m_splitter->addWidget(m_scrollArea);
+    // Message list: a ring-buffer model painted by the bubble delegate, so
+    // only visible rows cost anything and history size stays bounded
+    m_messageModel   = new MessageListModel(this);
+    m_messageModel->setCapacity(QSettings("MQTTAssistant", "MQTT_assistant")
+                                    .value("chat/maxMessages", MessageListModel::kDefaultCapacity)
+                                    .toInt());
+    m_bubbleDelegate = new MessageBubbleDelegate(m_messageModel, this);
+
+    m_messageView = new QListView(m_splitter);
+    m_messageView->setObjectName("messagesContainer");
+    m_messageView->setStyleSheet("QListView { background-color: #f5f5f5; border: none; }");
+    m_messageView->setModel(m_messageModel);
+    m_messageView->setItemDelegate(m_bubbleDelegate);
+    m_messageView->setSelectionMode(QAbstractItemView::NoSelection);
+    m_messageView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_messageView->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+    m_messageView->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    m_messageView->setResizeMode(QListView::Adjust);
+    m_messageView->setLayoutMode(QListView::Batched);
+    m_messageView->setBatchSize(200);
+    m_messageView->setUniformItemSizes(false);
+    m_messageView->setContextMenuPolicy(Qt::CustomContextMenu);
+    m_splitter->addWidget(m_messageView);
+
+    // Ask for the next history page a screen before the top is reached
+    connect(m_messageView->verticalScrollBar(), &QScrollBar::valueChanged, this, [this](int value) {
+        if (value <= m_messageView->viewport()->height())
+            emit olderHistoryRequested();
+    });
 
     // Input area
     QWidget *inputArea = new QWidget(m_splitter);
@@ -94,6 +112,8 @@ ChatWidget::ChatWidget(QWidget *parent)
 
     connect(m_sendBtn,      &QPushButton::clicked, this, &ChatWidget::onSendClicked);
     connect(m_subscribeBtn, &QPushButton::clicked, this, &ChatWidget::onSubscribeClicked);
+    connect(m_messageView,  &QListView::customContextMenuRequested,
+            this, &ChatWidget::onMessageContextMenu);
 
     loadTopicHistory();
 }
@@ -105,29 +125,44 @@ void ChatWidget::setClient(MqttClient *client)
 
 void ChatWidget::addMessage(const MessageRecord &msg)
 {
-    m_connectionId = msg.connectionId;
-    MessageBubbleItem *bubble = new MessageBubbleItem(msg, m_messagesContainer);
-    // Insert before the trailing stretch
-    m_messagesLayout->insertWidget(m_messagesLayout->count() - 1, bubble);
-    QTimer::singleShot(50, this, &ChatWidget::scrollToBottom);
+    addMessages({ msg });
+}
+
+void ChatWidget::addMessages(const QList<MessageRecord> &messages)
+{
+    if (messages.isEmpty())
+        return;
+    m_connectionId = messages.last().connectionId;
+    m_messageModel->appendMessages(messages);
+    scheduleScrollToBottom();
 }
 
 void ChatWidget::clearMessages()
 {
-    // Remove all bubble items (all except the trailing stretch)
-    while (m_messagesLayout->count() > 1) {
-        QLayoutItem *item = m_messagesLayout->takeAt(0);
-        if (item->widget())
-            item->widget()->deleteLater();
-        delete item;
-    }
+    m_messageModel->clear();
 }
 
 void ChatWidget::loadMessages(const QList<MessageRecord> &messages)
 {
     clearMessages();
-    for (const MessageRecord &msg : messages)
-        addMessage(msg);
+    addMessages(messages);
+}
+
+void ChatWidget::prependMessages(const QList<MessageRecord> &messages)
+{
+    const QModelIndex anchor = m_messageView->indexAt(QPoint(0, 0));
+    const int offset = anchor.isValid() ? m_messageView->visualRect(anchor).top() : 0;
+    const int inserted = m_messageModel->prependMessages(messages);
+    if (inserted == 0 || !anchor.isValid())
+        return;
+
+    // Restore once the view has laid out the new rows
+    const int row = anchor.row() + inserted;
+    QTimer::singleShot(0, this, [this, row, offset]() {
+        m_messageView->scrollTo(m_messageModel->index(row), QAbstractItemView::PositionAtTop);
+        QScrollBar *bar = m_messageView->verticalScrollBar();
+        bar->setValue(bar->value() - offset);
+    });
 }
 
 void ChatWidget::onSendClicked()
@@ -189,11 +224,43 @@ void ChatWidget::onClearClicked()
         emit clearHistoryRequested(m_connectionId);
 }
 
+void ChatWidget::scheduleScrollToBottom()
+{
+    // Coalesce: one scroll per burst of messages, after the view has laid out
+    if (m_scrollPending)
+        return;
+    m_scrollPending = true;
+    QTimer::singleShot(50, this, &ChatWidget::scrollToBottom);
+}
+
 void ChatWidget::scrollToBottom()
 {
-    m_scrollArea->verticalScrollBar()->setValue(
-        m_scrollArea->verticalScrollBar()->maximum()
-    );
+    m_scrollPending = false;
+    m_messageView->scrollToBottom();
+}
+
+void ChatWidget::onMessageContextMenu(const QPoint &pos)
+{
+    QModelIndex index = m_messageView->indexAt(pos);
+    if (!index.isValid()) return;
+    // Copy the texts up front: the ring buffer may evict this row while the
+    // menu is open
+    const ChatRow &row = m_messageModel->row(index.row());
+    const QString fullText = MessageBubbleDelegate::copyText(row);
+    const QString topic    = row.msg.topic;
+    const QString payload  = PayloadFormat::toDisplayText(row.msg.payload);
+
+    QMenu menu(this);
+    QAction *actCopy        = menu.addAction("复制");
+    QAction *actCopyTopic   = menu.addAction("复制主题");
+    QAction *actCopyPayload = menu.addAction("复制内容");
+    QAction *chosen = menu.exec(m_messageView->viewport()->mapToGlobal(pos));
+    if (chosen == actCopy)
+        QApplication::clipboard()->setText(fullText);
+    else if (chosen == actCopyTopic)
+        QApplication::clipboard()->setText(topic);
+    else if (chosen == actCopyPayload)
+        QApplication::clipboard()->setText(payload);
 }
 
 void ChatWidget::saveTopicHistory()
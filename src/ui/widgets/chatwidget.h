@@ -2,7 +2,7 @@
 #define CHATWIDGET_H
 
 #include <QWidget>
-#include <QScrollArea>
+#include <QListView>
 #include <QVBoxLayout>
 #include <QComboBox>
 #include <QTextEdit>
@@ -12,6 +12,8 @@
 #include "core/models.h"
 
 class MqttClient;
+class MessageListModel;
+class MessageBubbleDelegate;
 
 class ChatWidget : public QWidget
 {
@@ -21,8 +23,12 @@ public:
 
     void setClient(MqttClient *client);
     void addMessage(const MessageRecord &msg);
+    void addMessages(const QList<MessageRecord> &messages);
     void clearMessages();
     void loadMessages(const QList<MessageRecord> &messages);
+    // Older history (oldest first) above the current rows, keeping the
+    // rows the user is reading in place
+    void prependMessages(const QList<MessageRecord> &messages);
 
     QComboBox *topicCombo() const { return m_topicCombo; }
 
@@ -34,6 +40,7 @@ signals:
     void sendRequested(const QString &topic, const QString &payload);
     void subscribeRequested(const QString &topic);
     void clearHistoryRequested(int connectionId); // emitted when user wants DB clear
+    void olderHistoryRequested(); // scrolled to within a screen of the top
 
 public slots:
     void onClearClicked();
@@ -42,12 +49,16 @@ private slots:
     void onSendClicked();
     void onSubscribeClicked();
     void scrollToBottom();
+    void onMessageContextMenu(const QPoint &pos);
 
 private:
-    QScrollArea  *m_scrollArea;
-    QWidget      *m_messagesContainer;
-    QVBoxLayout  *m_messagesLayout;
-    QSplitter    *m_splitter;
+    void scheduleScrollToBottom();
+
+    QListView             *m_messageView;
+    MessageListModel      *m_messageModel;
+    MessageBubbleDelegate *m_bubbleDelegate;
+    QSplitter             *m_splitter;
+    bool                   m_scrollPending;
 
     QComboBox    *m_topicCombo;
     QTextEdit    *m_payloadEdit;
@@ -1,13 +1,15 @@
 #include "commandpanel.h"
 #include "core/mqttclient.h"
+#include "ui/dialogs/loadtestdialog.h"
 #include <QVBoxLayout>
 #include <QMenu>
 #include <QAction>
 #include <QMessageBox>
-#include <QDateTime>
+#include <QThread>
 CommandPanel::CommandPanel(QWidget *parent)
     : QWidget(parent)
     , m_client(nullptr)
+    , m_loadRunning(false)
 {
     QVBoxLayout *layout = new QVBoxLayout(this);
     layout->setContentsMargins(0, 0, 0, 0);
@@ -17,6 +19,12 @@ CommandPanel::CommandPanel(QWidget *parent)
     m_listWidget->setContextMenuPolicy(Qt::CustomContextMenu);
     layout->addWidget(m_listWidget);
 
+    m_loadLabel = new QLabel(this);
+    m_loadLabel->setWordWrap(true);
+    m_loadLabel->setStyleSheet("color: #888888; padding: 4px;");
+    m_loadLabel->hide();
+    layout->addWidget(m_loadLabel);
+
     connect(m_listWidget, &QListWidget::customContextMenuRequested,
             this, &CommandPanel::onContextMenu);
 }
@@ -24,6 +32,9 @@ CommandPanel::CommandPanel(QWidget *parent)
 CommandPanel::~CommandPanel()
 {
     qDeleteAll(m_loopTimers);
+    stopLoadTest();
+    if (m_loadGenerator)
+        m_loadGenerator->deleteLater();
 }
 
 void CommandPanel::setClient(MqttClient *client)
@@ -34,6 +45,7 @@ void CommandPanel::setClient(MqttClient *client)
 void CommandPanel::addCommand(const CommandConfig &cmd)
 {
     m_commands[cmd.id] = cmd;
+    m_payloadTemplates[cmd.id] = MessageTemplate(cmd.payload);
     QListWidgetItem *item = new QListWidgetItem(cmd.name, m_listWidget);
     item->setData(Qt::UserRole, cmd.id);
     m_listWidget->addItem(item);
@@ -42,6 +54,7 @@ void CommandPanel::addCommand(const CommandConfig &cmd)
 void CommandPanel::updateCommand(const CommandConfig &cmd)
 {
     m_commands[cmd.id] = cmd;
+    m_payloadTemplates[cmd.id] = MessageTemplate(cmd.payload);
     QListWidgetItem *item = findItem(cmd.id);
     if (item)
         item->setText(cmd.name);
@@ -51,6 +64,7 @@ void CommandPanel::removeCommand(int id)
 {
     stopLoop(id);
     m_commands.remove(id);
+    m_payloadTemplates.remove(id);
     QListWidgetItem *item = findItem(id);
     if (item)
         delete m_listWidget->takeItem(m_listWidget->row(item));
@@ -61,6 +75,7 @@ void CommandPanel::clearCommands()
     for (int id : m_loopTimers.keys())
         stopLoop(id);
     m_commands.clear();
+    m_payloadTemplates.clear();
     m_listWidget->clear();
 }
 
@@ -76,12 +91,16 @@ void CommandPanel::onContextMenu(const QPoint &pos)
     QAction *actSend      = menu.addAction("发送");
     QAction *actStartLoop = menu.addAction("开始循环");
     QAction *actStopLoop  = menu.addAction("停止循环");
+    QAction *actStartLoad = menu.addAction("压力测试...");
+    QAction *actStopLoad  = menu.addAction("停止压力测试");
     menu.addSeparator();
     QAction *actEdit   = menu.addAction("编辑");
     QAction *actDelete = menu.addAction("删除");
 
     actStartLoop->setEnabled(!looping);
     actStopLoop->setEnabled(looping);
+    actStartLoad->setEnabled(!m_loadRunning);
+    actStopLoad->setEnabled(m_loadRunning);
 
     QAction *chosen = menu.exec(m_listWidget->viewport()->mapToGlobal(pos));
     if (!chosen) return;
@@ -89,6 +108,8 @@ void CommandPanel::onContextMenu(const QPoint &pos)
     if (chosen == actSend)      sendCommand(id);
     if (chosen == actStartLoop) startLoop(id);
     if (chosen == actStopLoop)  stopLoop(id);
+    if (chosen == actStartLoad) startLoadTest(id);
+    if (chosen == actStopLoad)  stopLoadTest();
     if (chosen == actEdit)      emit editRequested(id);
     if (chosen == actDelete)    emit deleteRequested(id);
 }
@@ -111,10 +132,10 @@ void CommandPanel::sendCommand(int commandId)
     if (!m_commands.contains(commandId)) return;
     const CommandConfig &cmd = m_commands[commandId];
 
-    // Substitute variables in payload: {{timestamp}}, {{topic}}
-    QString payload = cmd.payload;
-    payload.replace("{{timestamp}}", QDateTime::currentDateTime().toString(Qt::ISODate));
-    payload.replace("{{topic}}", cmd.topic);
+    // Render placeholders such as {{timestamp}} and {{topic}}; with no
+    // triggering message, {{payload...}} goes out as written
+    const MessageTemplate::Context context{cmd.topic, QString(), QByteArray(), false};
+    const QString payload = m_payloadTemplates.value(commandId).render(context);
 
     // Use invokeMethod so the call is safe even if client is on another thread
     QMetaObject::invokeMethod(m_client, "publish", Qt::QueuedConnection,
@@ -163,3 +184,60 @@ QListWidgetItem *CommandPanel::findItem(int commandId) const
     }
     return nullptr;
 }
+
+void CommandPanel::startLoadTest(int commandId)
+{
+    if (!m_client || !m_client->isConnected()) {
+        QMessageBox::warning(this, "未连接", "请先连接到 MQTT 服务器。");
+        return;
+    }
+    if (m_loadRunning || !m_commands.contains(commandId)) return;
+
+    LoadTestDialog dlg(m_commands[commandId], this);
+    if (dlg.exec() != QDialog::Accepted) return;
+
+    // Replace the generator from the previous run, if any
+    if (m_loadGenerator)
+        m_loadGenerator->deleteLater();
+
+    // Publish from the client's own thread: no per-message event hop
+    LoadGenerator *generator = new LoadGenerator(m_client);
+    generator->moveToThread(m_client->thread());
+    // The I/O thread outlives the connection, so follow the client instead:
+    // once it is gone the run ends and the generator goes with it
+    connect(m_client, &QObject::destroyed, generator, [generator]() {
+        generator->stop();
+        generator->deleteLater();
+    });
+    connect(m_client->thread(), &QThread::finished, generator, &QObject::deleteLater);
+    connect(generator, &LoadGenerator::statsUpdated, this, &CommandPanel::onLoadStats);
+    m_loadGenerator = generator;
+    m_loadRunning   = true;
+
+    m_loadLabel->setText("压测启动中...");
+    m_loadLabel->show();
+    QMetaObject::invokeMethod(generator, "start", Qt::QueuedConnection,
+                              Q_ARG(LoadProfile, dlg.profile()));
+}
+
+void CommandPanel::stopLoadTest()
+{
+    if (m_loadRunning && m_loadGenerator)
+        QMetaObject::invokeMethod(m_loadGenerator, "stop", Qt::QueuedConnection);
+}
+
+void CommandPanel::onLoadStats(const LoadStats &stats)
+{
+    m_loadRunning = stats.running;
+    QString text = QString("压测 %1 条/秒 · 已发 %2 · 延迟 %3 / %4 ms · 在途 %5")
+                       .arg(stats.achievedRate, 0, 'f', 0)
+                       .arg(stats.sent)
+                       .arg(stats.avgLatencyMs, 0, 'f', 2)
+                       .arg(stats.maxLatencyMs, 0, 'f', 2)
+                       .arg(stats.inFlight);
+    if (stats.failed > 0)
+        text += QString(" · 失败 %1").arg(stats.failed);
+    if (!stats.running)
+        text += " (已停止)";
+    m_loadLabel->setText(text);
+}
@@ -5,7 +5,11 @@
 #include <QListWidget>
 #include <QMap>
 #include <QTimer>
+#include <QLabel>
+#include <QPointer>
 #include "core/models.h"
+#include "core/loadgenerator.h"
+#include "core/messagetemplate.h"
 
 class MqttClient;
 
@@ -30,17 +34,26 @@ signals:
 private slots:
     void onContextMenu(const QPoint &pos);
     void onLoopTimer();
+    void onLoadStats(const LoadStats &stats);
 
 private:
     void sendCommand(int commandId);
     void startLoop(int commandId);
     void stopLoop(int commandId);
+    void startLoadTest(int commandId);
+    void stopLoadTest();
     QListWidgetItem *findItem(int commandId) const;
 
     QListWidget *m_listWidget;
     MqttClient  *m_client;
     QMap<int, CommandConfig> m_commands;   // id -> config
+    QMap<int, MessageTemplate> m_payloadTemplates; // id -> compiled payload
     QMap<int, QTimer*>       m_loopTimers; // id -> timer
+
+    // Load test: at most one per panel, running on the client's thread
+    QPointer<LoadGenerator> m_loadGenerator;
+    bool                    m_loadRunning;
+    QLabel                 *m_loadLabel;
 };
 
 #endif // COMMANDPANEL_H
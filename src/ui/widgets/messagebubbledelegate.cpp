@@ -0,0 +1,191 @@
+#include "messagebubbledelegate.h"
+#include "ui/models/messagelistmodel.h"
+#include "core/payloadformat.h"
+#include <QPainter>
+#include <QPainterPath>
+#include <QFontMetrics>
+#include <QAbstractItemView>
+#include <QJsonDocument>
+#include <QJsonParseError>
+#include <climits>
+
+static const int kOuterMarginH  = 8;
+static const int kOuterMarginV  = 4;
+static const int kPaddingH      = 12;
+static const int kPaddingV      = 8;
+static const int kSpacing       = 4;
+static const int kRadius        = 12;
+static const int kMinTextWidth  = 60;
+static const int kTextFlags     = Qt::TextWordWrap | Qt::TextWrapAnywhere;
+
+// Returns a display-friendly representation of a raw payload.
+static QString formatPayload(const QByteArray &payload)
+{
+    // Try JSON
+    QJsonParseError err;
+    QJsonDocument doc = QJsonDocument::fromJson(payload, &err);
+    if (err.error == QJsonParseError::NoError && !doc.isNull())
+        return QString::fromUtf8(doc.toJson(QJsonDocument::Indented)).trimmed();
+    return PayloadFormat::toDisplayText(payload);
+}
+
+// Returns a short type tag for the payload.
+static QString payloadTypeTag(const QByteArray &payload)
+{
+    if (!PayloadFormat::isUtf8(payload))
+        return "[HEX]";
+    QJsonParseError err;
+    QJsonDocument::fromJson(payload, &err);
+    if (err.error == QJsonParseError::NoError)
+        return "[JSON]";
+    return "[TEXT]";
+}
+
+static QFont smallFont(const QFont &base, bool bold)
+{
+    QFont f = base;
+    if (f.pointSizeF() > 0)
+        f.setPointSizeF(f.pointSizeF() - 2);
+    else
+        f.setPixelSize(qMax(8, f.pixelSize() - 2));
+    f.setBold(bold);
+    return f;
+}
+
+static QFont boldFont(const QFont &base)
+{
+    QFont f = base;
+    f.setBold(true);
+    return f;
+}
+
+static int viewWidth(const QStyleOptionViewItem &option)
+{
+    if (auto *view = qobject_cast<const QAbstractItemView *>(option.widget))
+        return view->viewport()->width();
+    return option.rect.width();
+}
+
+MessageBubbleDelegate::MessageBubbleDelegate(MessageListModel *model, QObject *parent)
+    : QStyledItemDelegate(parent)
+    , m_model(model)
+{
+}
+
+QString MessageBubbleDelegate::copyText(const ChatRow &row)
+{
+    return QString("[%1] %2\n%3")
+        .arg(row.msg.timestamp().toString("yyyy-MM-dd hh:mm:ss"))
+        .arg(row.msg.topic)
+        .arg(PayloadFormat::toDisplayText(row.msg.payload));
+}
+
+void MessageBubbleDelegate::ensureLayout(const ChatRow &row, const QStyleOptionViewItem &option) const
+{
+    if (!row.formatted) {
+        row.displayText = formatPayload(row.msg.payload);
+        row.tagText     = payloadTypeTag(row.msg.payload) + (row.msg.retained ? " [留存]" : "");
+        row.timeText    = row.msg.timestamp().toString("hh:mm:ss");
+        row.formatted   = true;
+    }
+
+    const int width = viewWidth(option);
+    if (row.hintWidth == width)
+        return;
+
+    // Bubbles take at most three quarters of the view, like the old widget rows
+    const int maxText = qMax(kMinTextWidth, width * 3 / 4 - 2 * kPaddingH);
+    const QRect bounds(0, 0, maxText, INT_MAX / 2);
+
+    QFontMetrics topicFm(boldFont(option.font));
+    QFontMetrics tagFm(smallFont(option.font, true));
+    QFontMetrics bodyFm(option.font);
+    QFontMetrics timeFm(smallFont(option.font, false));
+
+    row.topicSize   = topicFm.boundingRect(bounds, kTextFlags, row.msg.topic).size();
+    row.payloadSize = bodyFm.boundingRect(bounds, kTextFlags, row.displayText).size();
+    const int tagW  = tagFm.horizontalAdvance(row.tagText);
+    const int timeW = timeFm.horizontalAdvance(row.timeText);
+
+    const int contentW = qMax(qMax(row.topicSize.width(), row.payloadSize.width()),
+                              qMax(tagW, timeW));
+    const int contentH = row.topicSize.height() + tagFm.height()
+                       + row.payloadSize.height() + timeFm.height() + 3 * kSpacing;
+
+    // Rows span the full view width so outgoing bubbles can align right
+    row.bubbleWidth = contentW + 2 * kPaddingH;
+    row.sizeHint    = QSize(width, contentH + 2 * kPaddingV + 2 * kOuterMarginV);
+    row.hintWidth   = width;
+}
+
+QSize MessageBubbleDelegate::sizeHint(const QStyleOptionViewItem &option,
+                                      const QModelIndex &index) const
+{
+    if (!index.isValid() || index.row() >= m_model->rowCount())
+        return QSize();
+    const ChatRow &row = m_model->row(index.row());
+    ensureLayout(row, option);
+    return row.sizeHint;
+}
+
+void MessageBubbleDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option,
+                                  const QModelIndex &index) const
+{
+    if (!index.isValid() || index.row() >= m_model->rowCount())
+        return;
+    const ChatRow &row = m_model->row(index.row());
+    ensureLayout(row, option);
+
+    const bool outgoing = row.msg.outgoing;
+    const QColor bg     = outgoing ? QColor("#ea5413") : QColor("#ffffff");
+    const QColor border = outgoing ? bg : QColor("#dddddd");
+
+    const int bubbleW = row.bubbleWidth;
+    const int bubbleH = row.sizeHint.height() - 2 * kOuterMarginV;
+    const int bubbleX = outgoing ? option.rect.right() - kOuterMarginH - bubbleW + 1
+                                 : option.rect.left() + kOuterMarginH;
+    const QRect bubble(bubbleX, option.rect.top() + kOuterMarginV, bubbleW, bubbleH);
+
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing);
+
+    QPainterPath path;
+    path.addRoundedRect(QRectF(bubble).adjusted(0.5, 0.5, -0.5, -0.5), kRadius, kRadius);
+    painter->setPen(border);
+    painter->setBrush(bg);
+    painter->drawPath(path);
+
+    const int textX = bubble.left() + kPaddingH;
+    const int textW = bubble.width() - 2 * kPaddingH;
+    int y = bubble.top() + kPaddingV;
+
+    // Topic (bold)
+    painter->setFont(boldFont(option.font));
+    painter->setPen(outgoing ? QColor("#ffffff") : QColor("#1e1e2e"));
+    painter->drawText(QRect(textX, y, textW, row.topicSize.height()), kTextFlags, row.msg.topic);
+    y += row.topicSize.height() + kSpacing;
+
+    // Type tag
+    const QFont tagFont = smallFont(option.font, true);
+    painter->setFont(tagFont);
+    painter->setPen(outgoing ? QColor(255, 255, 255, 217) : QColor("#f39800"));
+    const int tagH = QFontMetrics(tagFont).height();
+    painter->drawText(QRect(textX, y, textW, tagH), Qt::AlignLeft | Qt::AlignVCenter, row.tagText);
+    y += tagH + kSpacing;
+
+    // Payload
+    painter->setFont(option.font);
+    painter->setPen(outgoing ? QColor("#fff5f0") : QColor("#333333"));
+    painter->drawText(QRect(textX, y, textW, row.payloadSize.height()), kTextFlags, row.displayText);
+    y += row.payloadSize.height() + kSpacing;
+
+    // Timestamp
+    const QFont timeFont = smallFont(option.font, false);
+    painter->setFont(timeFont);
+    painter->setPen(outgoing ? QColor(255, 255, 255, 178) : QColor("#888888"));
+    painter->drawText(QRect(textX, y, textW, QFontMetrics(timeFont).height()),
+                      (outgoing ? Qt::AlignRight : Qt::AlignLeft) | Qt::AlignVCenter,
+                      row.timeText);
+
+    painter->restore();
+}
@@ -0,0 +1,34 @@
+#ifndef MESSAGEBUBBLEDELEGATE_H
+#define MESSAGEBUBBLEDELEGATE_H
+
+#include <QStyledItemDelegate>
+
+class MessageListModel;
+struct ChatRow;
+
+/**
+ * Paints chat bubbles straight onto the view instead of building a widget
+ * tree per message. Text formatting and wrapped text sizes are computed once
+ * per row and view width, then cached on the row.
+ */
+class MessageBubbleDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+public:
+    explicit MessageBubbleDelegate(MessageListModel *model, QObject *parent = nullptr);
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option,
+               const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option,
+                   const QModelIndex &index) const override;
+
+    // Full text used by the "copy" context action
+    static QString copyText(const ChatRow &row);
+
+private:
+    void ensureLayout(const ChatRow &row, const QStyleOptionViewItem &option) const;
+
+    MessageListModel *m_model;
+};
+
+#endif // MESSAGEBUBBLEDELEGATE_H